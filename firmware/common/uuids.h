@@ -22,18 +22,29 @@
 #define PRESSURE_SENSOR_UUID "f7ec0786-e220-48d6-a837-8b4cc1762ed9"
 #define PRESSURE_SENSOR2_UUID "9ebe6bd8-f61e-4f6c-aaf3-f7c4daf624ba"
 #define PRESSURE_SENSOR_ERROR_UUID "9676e807-95b2-45f1-a466-55a15e55d6a5"
+#define PRESSURE_SENSOR2_ERROR_UUID "149f54de-81b0-4a6d-982e-b62345992c34"
+#define PRESSURE_SENSOR_REJECTED_UUID "38917f61-10da-44d0-bf76-08bf77c2fc46"
+#define PRESSURE_SENSOR_FAILED_TRANSFERS_UUID "7eb7bb29-c964-4f72-909c-d5429367220f"
+#define PRESSURE_SENSOR_BUS_RECOVERIES_UUID "83847714-73a2-47e0-92ad-cbd443768294"
+#define PRESSURE_SENSOR2_REJECTED_UUID "0aada6ef-acb2-4927-b251-9c341be1a229"
+#define PRESSURE_SENSOR2_FAILED_TRANSFERS_UUID "9eaeaac2-7e2c-41ce-ad86-036f25503c4c"
+#define PRESSURE_SENSOR2_BUS_RECOVERIES_UUID "3222de50-197e-4688-93a6-bc97a7b0f0a6"
 #define CENTRAL_DIMMER_UUID "3c50614b-4652-4a59-9076-9bbab527b26d"
 #define OUTER_DIMMER_UUID "cd85f394-cb51-4d70-860a-f12115646cff"
+#define CENTRAL_DIMMER_CALIBRATION_UUID "fe5d8636-d55b-4eda-b278-1e0a4aab5189"
+#define OUTER_DIMMER_CALIBRATION_UUID "bbfe5d3a-e951-4d22-9d50-ad3874c97b80"
 #define MOTOR_POSITION_UUID "e4e96eae-241e-4c78-b2be-d4f537978069"
 #define MOTOR_VELOCITY_UUID "39c5eef9-c193-45a6-ba01-ecba49c22f1b"
 #define MOTOR_TORQUE_UUID "3f1f1c14-0875-4aa3-861e-4f7f696be74c"
 #define MOTOR_ERROR_UUID "511418cf-29f6-4b6f-8472-fa384118175f"
+#define MOTOR_CALIBRATION_UUID "12594cd8-5ac0-4370-a793-f9aad35d4451"
 #define SERVO_ANGLE_UUID "1b3c1525-6532-436a-88e8-ed2a15593e89"
 #define JOYSTICK_UUID "60fbb217-d4a4-45c7-ab23-e66cf3cb741b"
 #define PRESSURE_CONTROLLER_UUID "6252787b-cb91-412b-8a11-7b0cbfc59e3e"
 #define BUMPER_PRESSURE_CONTROLLER_UUID "3f13d4bd-44d6-44d8-a50f-07c98d44380a"
 #define PROPORTIONAL_VALVE_UUID "ce578d11-9f20-4421-b361-521d07fa6d30"
 #define ON_OFF_VALVE_UUID "078ebef2-ff28-49fc-8791-5105a1b15dcc"
+#define VALVE_PRESSURE_REFERENCE_UUID "bc464a5e-e1f3-4330-ab15-b350f40e97f2"
 #define VALVE_STATE_UUID "35061cd5-efc6-404c-8d91-b72133165e55"
 #define AUTO_CONTROL_MODE_UUID "62ad8224-6b8e-43b9-ba2a-9ddd24b20693"
 #define AUTO_CONTROL_PROGRESS_UUID "b967a6a1-bc6c-43ed-92a2-2c123e2d71fc"
@@ -43,17 +54,28 @@ static const char *CHARACTERISTIC_UUIDS[] = {
     PRESSURE_SENSOR_UUID,
     PRESSURE_SENSOR2_UUID,
     PRESSURE_SENSOR_ERROR_UUID,
+    PRESSURE_SENSOR2_ERROR_UUID,
+    PRESSURE_SENSOR_REJECTED_UUID,
+    PRESSURE_SENSOR_FAILED_TRANSFERS_UUID,
+    PRESSURE_SENSOR_BUS_RECOVERIES_UUID,
+    PRESSURE_SENSOR2_REJECTED_UUID,
+    PRESSURE_SENSOR2_FAILED_TRANSFERS_UUID,
+    PRESSURE_SENSOR2_BUS_RECOVERIES_UUID,
     CENTRAL_DIMMER_UUID,
     OUTER_DIMMER_UUID,
+    CENTRAL_DIMMER_CALIBRATION_UUID,
+    OUTER_DIMMER_CALIBRATION_UUID,
     MOTOR_POSITION_UUID,
     MOTOR_VELOCITY_UUID,
     MOTOR_TORQUE_UUID,
     MOTOR_ERROR_UUID,
+    MOTOR_CALIBRATION_UUID,
     SERVO_ANGLE_UUID,
     JOYSTICK_UUID,
     PRESSURE_CONTROLLER_UUID,
     PROPORTIONAL_VALVE_UUID,
     ON_OFF_VALVE_UUID,
+    VALVE_PRESSURE_REFERENCE_UUID,
     VALVE_STATE_UUID,
     AUTO_CONTROL_MODE_UUID,
     AUTO_CONTROL_PROGRESS_UUID,
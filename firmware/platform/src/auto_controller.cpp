@@ -76,6 +76,8 @@ void AutoController::set_mode(float mode)
         return;
 
     this->mode = (AutoControlMode)mode;
+    this->dimmer->set_sweep_allowed(this->mode == AutoControlMode::IDLE);
+    this->dimmer2->set_sweep_allowed(this->mode == AutoControlMode::IDLE);
     if (this->mode == AutoControlMode::IDLE) {
         this->dimmer->set_voltage(0);
         this->dimmer2->set_voltage(0);
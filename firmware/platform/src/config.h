@@ -34,6 +34,8 @@
 #define VOLTAGE_DIMMER_PWM_PIN 18
 #define VOLTAGE_DIMMER_LEDC_CHANNEL 0
 #define MAX_DIMMER_VOLTAGE 120.0
+#define DIMMER_SLEW_RATE_UP 60.0
+#define DIMMER_SLEW_RATE_DOWN 120.0
 
 #define ENABLE_SERVO 1
 #define SERVO_PWM_PIN 19
@@ -45,14 +47,24 @@
 
 #define LEFT_VALVE_PIN 32
 #define RIGHT_VALVE_PIN 27
+// The Wedge's valves switch the rail, so they stay on/off.
+#define STEERING_PROPORTIONAL 0
 #define VALVE_DIGITAL_PIN1 25
 #define VALVE_DIGITAL_PIN2 26
 #define RAIL_STATE_PIN 35
+#define RAIL_STATE_DEBOUNCE_TIME 0.01
 #define BOX_TO_RAIL_PIN 33
 
 
 #define ENABLE_CONTROL_PANEL 0
 
+// Proportional bleed valve with an on/off valve in series. Set the pins to where the valves are
+// wired before enabling it.
+#define ENABLE_PROPORTIONAL_VALVE 0
+#define PROPORTIONAL_VALVE_PWM_PIN -1
+#define PROPORTIONAL_VALVE_LEDC_CHANNEL 6
+#define ON_OFF_VALVE_PIN -1
+
 #define REFERENCE_TORQUE 0.0
 #define SHEET_LENGTH 12.0
 #define PRESSURE_LIMIT 3.0
@@ -85,12 +97,22 @@
 #define VOLTAGE_DIMMER_PWM_PIN 18
 #define VOLTAGE_DIMMER_LEDC_CHANNEL 0
 #define MAX_DIMMER_VOLTAGE 120.0
+#define DIMMER_SLEW_RATE_UP 60.0
+#define DIMMER_SLEW_RATE_DOWN 120.0
 #define VOLTAGE_DIMMER2_PWM_PIN 5
 #define VOLTAGE_DIMMER2_LEDC_CHANNEL 3
+#define DIMMER2_SLEW_RATE_UP 60.0
+#define DIMMER2_SLEW_RATE_DOWN 120.0
 
 #define LEFT_VALVE_PIN 25
 #define RIGHT_VALVE_PIN 26
+#define STEERING_PROPORTIONAL 1
+#define STEERING_LEFT_LEDC_CHANNEL 4
+#define STEERING_RIGHT_LEDC_CHANNEL 5
+#define STEERING_PWM_FREQUENCY 20.0
+#define STEERING_DEADBAND 0.1
 #define RAIL_STATE_PIN -1
+#define RAIL_STATE_DEBOUNCE_TIME 0.01
 #define BOX_TO_RAIL_PIN -1
 
 #define ENABLE_SERVO 0
@@ -101,6 +123,13 @@
 
 #define ENABLE_CONTROL_PANEL 0
 
+// Proportional bleed valve with an on/off valve in series. Set the pins to where the valves are
+// wired before enabling it.
+#define ENABLE_PROPORTIONAL_VALVE 0
+#define PROPORTIONAL_VALVE_PWM_PIN -1
+#define PROPORTIONAL_VALVE_LEDC_CHANNEL 6
+#define ON_OFF_VALVE_PIN -1
+
 #define REFERENCE_TORQUE 1.25
 #define SHEET_LENGTH 26
 #define PRESSURE_LIMIT 1.0
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <soc/gpio_struct.h>
+#include "input_pin.h"
+
+InputPin::InputPin()
+{
+    this->pin = -1;
+    this->mode = INPUT;
+    this->debounce_time = 0;
+    this->edges = nullptr;
+    this->last_edge_level = false;
+    this->last_edge_time = 0;
+    this->level = false;
+    this->lockout_start = 0;
+    this->locked_out = false;
+}
+
+InputPin::InputPin(int32_t pin, uint8_t mode, float debounce_time)
+{
+    this->pin = pin;
+    this->mode = mode;
+    this->debounce_time = (uint32_t)(debounce_time * 1e6);
+    this->edges = nullptr;
+    this->last_edge_level = false;
+    this->last_edge_time = 0;
+    this->level = false;
+    this->lockout_start = 0;
+    this->locked_out = false;
+}
+
+void InputPin::start()
+{
+    if (this->pin < 0)
+        return;
+
+    pinMode(this->pin, this->mode);
+    if (this->edges == nullptr)
+        this->edges = xQueueCreate(INPUT_PIN_QUEUE_LENGTH, sizeof(InputEvent));
+    this->level = this->read_level();
+    this->last_edge_level = this->level;
+    this->last_edge_time = micros();
+    this->locked_out = false;
+    attachInterruptArg(this->pin, &InputPin::handle_interrupt, this, CHANGE);
+}
+
+// Reads the input register directly, digitalRead() isn't safe to call from an interrupt.
+bool IRAM_ATTR InputPin::read_level()
+{
+    if (this->pin < 32)
+        return (GPIO.in >> this->pin) & 1;
+    return (GPIO.in1.data >> (this->pin - 32)) & 1;
+}
+
+void IRAM_ATTR InputPin::handle_interrupt(void *argument)
+{
+    InputPin *input = (InputPin *)argument;
+    InputEvent edge = {input->read_level(), (uint32_t)micros()};
+    input->last_edge_level = edge.level;
+    input->last_edge_time = edge.time;
+
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(input->edges, &edge, &woken);
+    if (woken == pdTRUE)
+        portYIELD_FROM_ISR();
+}
+
+// Returns false when there is no new event. Edges lost to a full queue are made up for by the
+// last edge the interrupt saw.
+bool InputPin::read_event(InputEvent *event)
+{
+    if (this->edges == nullptr)
+        return false;
+
+    InputEvent edge;
+    while (xQueueReceive(this->edges, &edge, 0) == pdTRUE) {
+        if (this->locked_out && edge.time - this->lockout_start < this->debounce_time)
+            continue;
+        this->locked_out = false;
+        if (edge.level == this->level)
+            continue;
+
+        this->level = edge.level;
+        this->lockout_start = edge.time;
+        this->locked_out = true;
+        *event = edge;
+        return true;
+    }
+
+    if (this->locked_out && micros() - this->lockout_start < this->debounce_time)
+        return false;
+    this->locked_out = false;
+
+    bool last_level = this->last_edge_level;
+    uint32_t last_time = this->last_edge_time;
+    if (last_level == this->level)
+        return false;
+    this->level = last_level;
+    this->lockout_start = last_time;
+    this->locked_out = true;
+    *event = {last_level, last_time};
+    return true;
+}
+
+// The debounced level, as of the last read_event().
+bool InputPin::get_level()
+{
+    return this->level;
+}
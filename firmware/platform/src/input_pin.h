@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define INPUT_PIN_QUEUE_LENGTH 16
+
+struct InputEvent {
+    bool level;
+    uint32_t time;
+};
+
+// GPIO input read through interrupts. The interrupt timestamps every edge and queues it, and
+// read_event() turns the edges into debounced events for the owner: a change is reported as soon
+// as its first edge arrives, with that edge's time, and further edges are ignored for the
+// debounce time. If the pin settled on the other level meanwhile, that is reported once the
+// debounce time is over.
+class InputPin {
+public:
+    InputPin();
+
+    InputPin(int32_t pin, uint8_t mode, float debounce_time);
+
+    void start();
+
+    bool read_event(InputEvent *event);
+
+    bool get_level();
+
+private:
+    static void IRAM_ATTR handle_interrupt(void *argument);
+
+    bool read_level();
+
+    int32_t pin;
+    uint8_t mode;
+    uint32_t debounce_time;
+    QueueHandle_t edges;
+    volatile bool last_edge_level;
+    volatile uint32_t last_edge_time;
+    bool level;
+    uint32_t lockout_start;
+    bool locked_out;
+};
@@ -19,6 +19,7 @@
 
 #include "service.h"
 #include "pressure_sensor.h"
+#include "pressure_sampler.h"
 #include "motor_controller.h"
 #include "voltage_dimmer.h"
 #include "pressure_controller.h"
@@ -27,6 +28,7 @@
 #include "valve.h"
 #include "steering.h"
 #include "wedges_controller.h"
+#include "proportional_valve.h"
 #include "config.h"
 #include "common/uuids.h"
 
@@ -34,21 +36,25 @@ TwoWire default_I2C = TwoWire(0);
 TwoWire other_I2C = TwoWire(1);
 
 static Service service;
-static PressureSensor pressure_sensor1(PRESSURE_SENSOR_UUID, PRESSURE_SENSOR_ERROR_UUID, &default_I2C, 22, 21);
-static MotorController motor_controller(MOTOR_POSITION_UUID, MOTOR_VELOCITY_UUID, MOTOR_TORQUE_UUID, MOTOR_ERROR_UUID, &Serial1, MOTOR_CONTROLLER_RX_PIN, MOTOR_CONTROLLER_TX_PIN);
-static VoltageDimmer voltage_dimmer1(CENTRAL_DIMMER_UUID, VOLTAGE_DIMMER_PWM_PIN, VOLTAGE_DIMMER_LEDC_CHANNEL);
+static PressureSensor pressure_sensor1(PRESSURE_SENSOR_UUID, PRESSURE_SENSOR_ERROR_UUID, PRESSURE_SENSOR_REJECTED_UUID, PRESSURE_SENSOR_FAILED_TRANSFERS_UUID, PRESSURE_SENSOR_BUS_RECOVERIES_UUID, "offset1", &default_I2C, 22, 21);
+static MotorController motor_controller(MOTOR_POSITION_UUID, MOTOR_VELOCITY_UUID, MOTOR_TORQUE_UUID, MOTOR_ERROR_UUID, MOTOR_CALIBRATION_UUID, &Serial1, MOTOR_CONTROLLER_RX_PIN, MOTOR_CONTROLLER_TX_PIN);
+static VoltageDimmer voltage_dimmer1(CENTRAL_DIMMER_UUID, CENTRAL_DIMMER_CALIBRATION_UUID, "dimmer1", &pressure_sensor1, VOLTAGE_DIMMER_PWM_PIN, VOLTAGE_DIMMER_LEDC_CHANNEL);
 static Servo servo(SERVO_ANGLE_UUID, SERVO_PWM_PIN, SERVO_LEDC_CHANNEL);
 static Steering steering(JOYSTICK_UUID, LEFT_VALVE_PIN, RIGHT_VALVE_PIN);
 #if PLATFORM_TYPE == 0
-    static PressureSensor pressure_sensor2(PRESSURE_SENSOR2_UUID, PRESSURE_SENSOR_ERROR_UUID, &other_I2C, PRESSURE_SENSOR_SCL_PIN, PRESSURE_SENSOR_SDA_PIN);
+    static PressureSensor pressure_sensor2(PRESSURE_SENSOR2_UUID, PRESSURE_SENSOR2_ERROR_UUID, PRESSURE_SENSOR2_REJECTED_UUID, PRESSURE_SENSOR2_FAILED_TRANSFERS_UUID, PRESSURE_SENSOR2_BUS_RECOVERIES_UUID, "offset2", &other_I2C, PRESSURE_SENSOR_SCL_PIN, PRESSURE_SENSOR_SDA_PIN);
+    static PressureSampler pressure_sampler(&pressure_sensor1, &pressure_sensor2);
     static Valve valve(VALVE_STATE_UUID, VALVE_DIGITAL_PIN1, VALVE_DIGITAL_PIN2);
-    static WedgesController wedges_controller(AUTO_CONTROL_MODE_UUID, AUTO_CONTROL_PROGRESS_UUID, TIMER_UUID, &voltage_dimmer1, &motor_controller, &pressure_sensor1, &pressure_sensor2, &servo, &valve, &steering);
+    static WedgesController wedges_controller(AUTO_CONTROL_MODE_UUID, AUTO_CONTROL_PROGRESS_UUID, TIMER_UUID, &voltage_dimmer1, &motor_controller, &pressure_sensor1, &pressure_sensor2, &pressure_sampler, &servo, &valve, &steering);
 #elif PLATFORM_TYPE == 1
-    static VoltageDimmer voltage_dimmer2(OUTER_DIMMER_UUID, VOLTAGE_DIMMER2_PWM_PIN, VOLTAGE_DIMMER2_LEDC_CHANNEL);
+    static VoltageDimmer voltage_dimmer2(OUTER_DIMMER_UUID, OUTER_DIMMER_CALIBRATION_UUID, "dimmer2", &pressure_sensor1, VOLTAGE_DIMMER2_PWM_PIN, VOLTAGE_DIMMER2_LEDC_CHANNEL);
     static PressureController bumper_pressure_controller(BUMPER_PRESSURE_CONTROLLER_UUID, &voltage_dimmer2, &pressure_sensor1);
     static AutoController auto_controller(AUTO_CONTROL_MODE_UUID, AUTO_CONTROL_PROGRESS_UUID, &voltage_dimmer1, &voltage_dimmer2, &motor_controller, &pressure_sensor1, &servo);
 #endif
 static PressureController pressure_controller(PRESSURE_CONTROLLER_UUID, &voltage_dimmer1, &pressure_sensor1);
+#if ENABLE_PROPORTIONAL_VALVE
+    static ProportionalValve proportional_valve(PROPORTIONAL_VALVE_UUID, ON_OFF_VALVE_UUID, VALVE_PRESSURE_REFERENCE_UUID, &pressure_sensor1, PROPORTIONAL_VALVE_PWM_PIN, PROPORTIONAL_VALVE_LEDC_CHANNEL, ON_OFF_VALVE_PIN);
+#endif
 
 float prev_time = millis();
 void setup()
@@ -56,6 +62,17 @@ void setup()
     Serial.begin(BAUD_RATE);
     while (!Serial);  
 
+    voltage_dimmer1.set_slew_rates(DIMMER_SLEW_RATE_UP, DIMMER_SLEW_RATE_DOWN);
+#if PLATFORM_TYPE == 1
+    voltage_dimmer2.set_slew_rates(DIMMER2_SLEW_RATE_UP, DIMMER2_SLEW_RATE_DOWN);
+#endif
+#if PRESSURE_TRACE
+    pressure_sensor1.set_trace(true);
+#endif
+#if STEERING_PROPORTIONAL
+    steering.set_proportional(STEERING_LEFT_LEDC_CHANNEL, STEERING_RIGHT_LEDC_CHANNEL, STEERING_PWM_FREQUENCY, STEERING_DEADBAND);
+#endif
+
 #if ENABLE_CONTROL_PANEL
     service.add_peripheral(&control_panel);
 #endif
@@ -65,6 +82,7 @@ service.add_peripheral(&servo);
 service.add_peripheral(&steering);
 #if PLATFORM_TYPE == 0   
     service.add_peripheral(&pressure_sensor2);
+    service.add_peripheral(&pressure_sampler);
     service.add_peripheral(&valve);
     service.add_peripheral(&wedges_controller);
 #elif PLATFORM_TYPE == 1
@@ -72,6 +90,9 @@ service.add_peripheral(&steering);
     service.add_peripheral(&auto_controller);
 #endif
 //service.add_peripheral(&pressure_controller);
+#if ENABLE_PROPORTIONAL_VALVE
+    service.add_peripheral(&proportional_valve);
+#endif
 
 #if ENABLE_MOTOR_CONTROLLER
     service.add_peripheral(&motor_controller);
@@ -86,9 +107,7 @@ void loop()
     #if PLATFORM_TYPE == 0
         //Serial.print(">Pressure 2: ");
         //Serial.println(pressure_sensor2.get_pressure());
-        if (voltage_dimmer1.get_voltage() == 0.0) {
-            pressure_sensor2.pressure_offset = pressure_sensor1.pressure_offset;
-        }
+        pressure_sensor2.set_calibrating(voltage_dimmer1.get_voltage() == 0.0);
     #endif
    
     //Serial.print(">Pressure 1: ");
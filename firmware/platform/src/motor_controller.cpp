@@ -20,14 +20,39 @@
 #include "config.h"
 
 static const float MOTOR_UPDATE_INTERVAL = 0.002;
+static const float FEEDBACK_RATE_INTERVAL = 1.0;
+static const float CALIBRATION_POLL_INTERVAL = 0.1;
+static const float CALIBRATION_TIMEOUT = 60.0;
+// Velocities are in motor turns/s and torques in Nm, as written to the ODrive.
+static const float VELOCITY_DEADBAND = 0.01;
+static const float TORQUE_DEADBAND = 0.01;
+static const float MAX_COMMAND_RATE = 50.0;
+static const float MAX_ACCELERATION = 20.0;
+static const float MAX_JERK = 100.0;
+// Controllers stopping the motor should not wait for the gentle acceleration profile. This brings
+// BASE_SPEED to rest in about 0.6 s while still ramping the torque.
+static const float STOP_ACCELERATION = 60.0;
+static const float STOP_JERK = 600.0;
+// The health poll (axis state and procedure result) is slow while the axis is fine and speeds up
+// while it reports a fault. A missed feedback reply triggers one right away.
+static const float HEALTH_POLL_INTERVAL = 0.5;
+static const float FAULT_HEALTH_POLL_INTERVAL = 0.02;
+// Health samples in a row that must report a fault before it is raised as a control error.
+static const int HEALTH_FAULT_SAMPLES = 3;
+// The Arduino loop (I2C pressure reads, controllers) runs on core 1 at priority 1 and the BLE
+// host runs on core 0, so the motor task sits on core 1 just above the loop.
+static const BaseType_t MOTOR_TASK_CORE = 1;
+static const UBaseType_t MOTOR_TASK_PRIORITY = 3;
+static const uint32_t MOTOR_TASK_STACK_SIZE = 4096;
 
 enum class AxisState {
     IDLE = 1,
     FULL_CALIBRATION_SEQUENCE = 3,
+    ENCODER_OFFSET_CALIBRATION = 7,
     CLOSED_LOOP_CONTROL = 8,
 };
 
-MotorController::MotorController(const char *position_uuid, const char *velocity_uuid, const char *torque_uuid, const char *error_uuid, HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin)
+MotorController::MotorController(const char *position_uuid, const char *velocity_uuid, const char *torque_uuid, const char *error_uuid, const char *calibration_uuid, HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin)
 {
     this->serial = serial;
     this->rx_pin = rx_pin;
@@ -36,104 +61,380 @@ MotorController::MotorController(const char *position_uuid, const char *velocity
     this->velocity = 0.0;
     this->torque = 0.0;
     this->error = MotorControllerError::NONE;
+    this->calibration_state = MotorCalibrationState::STARTING;
+    this->calibration_time = 0;
+    this->calibration_start_time = 0;
+    this->reused_calibration = false;
+    this->boot_time = 0;
+    this->ready_time = 0.0;
+    this->polling_mode = MotorPollingMode::PIPELINED;
+    this->poll_index = 0;
+    this->feedback_count = 0;
+    this->feedback_rate_start = 0;
+    this->feedback_rate = 0.0;
+    this->pending_error = -1;
+    this->stop_requested = false;
+    this->command_sequence = 1;
+    this->stop_sequence = 0;
+    this->commands = nullptr;
+    for (int i = 0; i < (int)MotorCommandType::COUNT; i++) {
+        this->command_cache[i].value = 0.0;
+        this->command_cache[i].time = 0;
+        this->command_cache[i].valid = false;
+        this->command_cache[i].pending = false;
+        this->command_cache[i].pending_value = 0.0;
+        this->command_cache[i].suppressed_count = 0;
+    }
+    this->active_command_type = MotorCommandType::VELOCITY;
+    this->set_command_limits(MotorCommandType::VELOCITY, VELOCITY_DEADBAND, MAX_COMMAND_RATE);
+    this->set_command_limits(MotorCommandType::TORQUE, TORQUE_DEADBAND, MAX_COMMAND_RATE);
+    this->set_trajectory_limits(MAX_ACCELERATION, MAX_JERK);
+    this->set_trajectory_stop_limits(STOP_ACCELERATION, STOP_JERK);
+    this->last_step_time = 0;
+    this->last_health_time = 0;
+    this->health_timeout_count = 0;
+    this->health_fault_count = 0;
+    this->procedure_result = 0;
+    this->task = nullptr;
+    this->publish_state();
     this->add_characteristic(position_uuid, nullptr, std::bind(&MotorController::get_position, this));
     this->add_characteristic(velocity_uuid, std::bind(&MotorController::set_velocity, this, std::placeholders::_1), std::bind(&MotorController::get_velocity, this));
     this->add_characteristic(torque_uuid, std::bind(&MotorController::set_torque, this, std::placeholders::_1), std::bind(&MotorController::get_torque, this));
     this->add_characteristic(error_uuid, std::bind(&MotorController::set_error, this, std::placeholders::_1), std::bind(&MotorController::get_error, this));
+    this->add_characteristic(calibration_uuid, nullptr, std::bind(&MotorController::get_calibration_state, this));
 }
 
 void MotorController::start()
 {
-    delay(4000);
+    this->boot_time = micros();
+    this->transport.begin(this->serial, this->rx_pin, this->tx_pin);
+    this->set_calibration_state(MotorCalibrationState::STARTING);
 
-    this->serial->begin(BAUD_RATE, SERIAL_8N1, this->rx_pin, this->tx_pin);
-    while (!this->serial);
-    this->serial->setTimeout(2000);
+    this->last_torque_time = micros();
+    this->feedback_rate_start = this->last_torque_time;
+    this->last_step_time = this->last_torque_time;
+    this->publish_state();
 
-    this->write_state((int)AxisState::FULL_CALIBRATION_SEQUENCE);
-    do {
-        delay(100);
-    } while ((AxisState)this->read_state() != AxisState::IDLE && this->error == MotorControllerError::NONE);
+    this->commands = xQueueCreate(1, sizeof(MotorCommand));
+    xTaskCreatePinnedToCore(&MotorController::task_entry, "motor", MOTOR_TASK_STACK_SIZE, this, MOTOR_TASK_PRIORITY, &this->task, MOTOR_TASK_CORE);
+}
 
-    this->write_state((int)AxisState::CLOSED_LOOP_CONTROL);
-    delay(100);
-    if ((AxisState)this->read_state() != AxisState::CLOSED_LOOP_CONTROL) {
-        this->set_error((float)MotorControllerError::CALIBRATION_FAILED);
-        return;
+void MotorController::update(float dt)
+{
+    Peripheral::update(dt);
+}
+
+void MotorController::task_entry(void *parameter)
+{
+    ((MotorController *)parameter)->run();
+}
+
+void MotorController::run()
+{
+    const TickType_t period = max((TickType_t)1, pdMS_TO_TICKS((uint32_t)(MOTOR_UPDATE_INTERVAL * 1000)));
+    TickType_t wake_time = xTaskGetTickCount();
+    while (true) {
+        this->step();
+        vTaskDelayUntil(&wake_time, period);
     }
+}
 
-    this->set_velocity(0.0);
-    this->last_update_time = micros();
+void MotorController::step()
+{
+    int pending_error = this->pending_error.exchange(-1);
+    if (pending_error >= 0)
+        this->error = (MotorControllerError)pending_error;
+
+    // A stop bypasses the command mailbox, so a setpoint sent after it can't overwrite it. A
+    // setpoint sent before the last stop is dropped, one sent after it is applied after the stop.
+    if (this->stop_requested.exchange(false) && this->calibration_state == MotorCalibrationState::READY)
+        this->stop();
+
+    // Commands are dropped until the axis is in closed loop control.
+    MotorCommand command;
+    if (xQueueReceive(this->commands, &command, 0) == pdTRUE && this->calibration_state == MotorCalibrationState::READY
+            && (int32_t)(command.sequence - this->stop_sequence) > 0)
+        this->queue_command(command);
+    uint32_t current_time = micros();
+    if (this->calibration_state == MotorCalibrationState::READY) {
+        this->update_trajectory(current_time);
+        this->flush_commands();
+    }
+    this->last_step_time = current_time;
+
+    this->transport.update();
+    this->check_responding();
+    this->read_feedback();
+    if (this->calibration_state == MotorCalibrationState::READY)
+        this->read_health();
+
+    if (this->error == MotorControllerError::NEEDS_RECALIBRATION && this->calibration_state != MotorCalibrationState::STARTING
+            && this->calibration_state != MotorCalibrationState::CALIBRATING && this->calibration_state != MotorCalibrationState::ENTERING_CLOSED_LOOP) {
+        Serial.println("Recalibration procedure");
+        this->run_calibration((int)AxisState::FULL_CALIBRATION_SEQUENCE);
+    }
+    this->update_calibration();
+
+    if (this->transport.is_idle() && this->calibration_state == MotorCalibrationState::READY)
+        this->request_health(current_time);
+    if (this->transport.is_idle() && this->calibration_state == MotorCalibrationState::READY)
+        this->request_feedback();
+
+    this->publish_state();
 }
 
-void MotorController::update(float dt)
+void MotorController::set_calibration_state(MotorCalibrationState state)
 {
-    Peripheral::update(dt);
+    this->calibration_state = state;
+    this->calibration_time = micros();
+}
+
+void MotorController::run_calibration(int procedure)
+{
+    this->write_state(procedure);
+    this->reused_calibration = false;
+    this->calibration_start_time = micros();
+    this->set_calibration_state(MotorCalibrationState::CALIBRATING);
+}
+
+void MotorController::enter_closed_loop()
+{
+    this->write_state((int)AxisState::CLOSED_LOOP_CONTROL);
+    this->calibration_start_time = micros();
+    this->set_calibration_state(MotorCalibrationState::ENTERING_CLOSED_LOOP);
+}
 
+void MotorController::update_calibration()
+{
     uint32_t current_time = micros();
-    if (current_time - this->last_update_time > (uint32_t)(MOTOR_UPDATE_INTERVAL * 1e6)) {
-        dt = (current_time - this->last_update_time) / 1e6;
-        this->last_update_time = current_time;
+    float elapsed = (current_time - this->calibration_time) / 1e6;
+    float value;
+
+    if (this->calibration_state == MotorCalibrationState::STARTING) {
+        // Wait for the ODrive to answer rather than for a fixed boot time. This keeps waiting if
+        // the ODrive never comes up, check_responding() reports it as not responding meanwhile.
+        if (this->transport.get_response(ODriveProperty::CURRENT_STATE, &value)) {
+            this->transport.request(ODriveProperty::MOTOR_CALIBRATED);
+            this->transport.request(ODriveProperty::ENCODER_CALIBRATED);
+            this->set_calibration_state(MotorCalibrationState::CHECKING_CALIBRATION);
+        } else if (elapsed >= CALIBRATION_POLL_INTERVAL && this->transport.is_idle()) {
+            this->transport.request(ODriveProperty::CURRENT_STATE);
+            this->calibration_time = current_time;
+        }
 
-        this->position = this->read_position() * -1.0 / GEARBOX_RATIO;
-        this->velocity = this->read_velocity() * -60.0 / GEARBOX_RATIO;
-        float torque = this->read_torque() * -TORQUE_CONSTANT;
+    } else if (this->calibration_state == MotorCalibrationState::CHECKING_CALIBRATION) {
+        if (!this->transport.is_idle())
+            return;
+
+        // The motor parameters are kept by save_configuration(), the encoder offset only
+        // survives a power cycle with an absolute or indexed encoder.
+        float motor_calibrated, encoder_calibrated;
+        bool motor_received = this->transport.get_response(ODriveProperty::MOTOR_CALIBRATED, &motor_calibrated);
+        bool encoder_received = this->transport.get_response(ODriveProperty::ENCODER_CALIBRATED, &encoder_calibrated);
+        if (!motor_received || !encoder_received) {
+            this->set_calibration_state(MotorCalibrationState::STARTING);
+        } else if (motor_calibrated != 0.0 && encoder_calibrated != 0.0) {
+            Serial.println("Reusing saved calibration");
+            this->reused_calibration = true;
+            this->enter_closed_loop();
+        } else if (motor_calibrated != 0.0) {
+            Serial.println("Encoder offset calibration");
+            this->run_calibration((int)AxisState::ENCODER_OFFSET_CALIBRATION);
+        } else {
+            Serial.println("Full calibration");
+            this->run_calibration((int)AxisState::FULL_CALIBRATION_SEQUENCE);
+        }
 
-        float alpha = exp(-6.0 * dt);
-        this->torque = (1.0 - alpha) * torque + alpha * this->torque;
+    } else if (this->calibration_state == MotorCalibrationState::CALIBRATING) {
+        if (this->transport.get_response(ODriveProperty::CURRENT_STATE, &value) && (AxisState)value == AxisState::IDLE) {
+            Serial.println("Calibration done");
+            this->enter_closed_loop();
+        } else if (this->error == MotorControllerError::NOT_RESPONDING
+                || (current_time - this->calibration_start_time) / 1e6 >= CALIBRATION_TIMEOUT) {
+            this->calibration_state = MotorCalibrationState::FAILED;
+            this->raise_error(MotorControllerError::CALIBRATION_FAILED);
+        } else if (elapsed >= CALIBRATION_POLL_INTERVAL && this->transport.is_idle()) {
+            this->transport.request(ODriveProperty::CURRENT_STATE);
+            this->calibration_time = current_time;
+        }
 
-        if (this->error == MotorControllerError::NEEDS_RECALIBRATION){
-            Serial.println("Recalibration procedure");
-            //this->error = MotorControllerError::NONE;
-            this->write_state((int)AxisState::FULL_CALIBRATION_SEQUENCE);
-            do {
-                delay(100);
-            } while ((AxisState)this->read_state() != AxisState::IDLE);
-            Serial.println("Recalibration done");
-            
-            this->write_state((int)AxisState::CLOSED_LOOP_CONTROL);
-            delay(100);
-            if ((AxisState)this->read_state() != AxisState::CLOSED_LOOP_CONTROL) {
-                this->set_error((float)MotorControllerError::CALIBRATION_FAILED);
-                return;
+    } else if (this->calibration_state == MotorCalibrationState::ENTERING_CLOSED_LOOP) {
+        if (this->transport.get_response(ODriveProperty::CURRENT_STATE, &value)) {
+            if ((AxisState)value == AxisState::CLOSED_LOOP_CONTROL) {
+                Serial.println("Closed loop control working");
+                this->write_command(MotorCommandType::VELOCITY, 0.0);
+                this->trajectory.reset(0.0);
+                this->calibration_state = MotorCalibrationState::READY;
+                this->raise_error(MotorControllerError::NONE);
+                this->report_ready_time(current_time);
+            } else if (this->reused_calibration) {
+                // The saved calibration did not hold up, so calibrate from scratch.
+                Serial.println("Full calibration");
+                this->run_calibration((int)AxisState::FULL_CALIBRATION_SEQUENCE);
+            } else {
+                this->calibration_state = MotorCalibrationState::FAILED;
+                this->raise_error(MotorControllerError::CALIBRATION_FAILED);
             }
-            Serial.println("Closed loop control working");
-            this->set_error((float)MotorControllerError::NONE);
+        } else if (elapsed >= CALIBRATION_POLL_INTERVAL && this->transport.is_idle()) {
+            this->transport.request(ODriveProperty::CURRENT_STATE);
+            this->calibration_time = current_time;
+        } else if ((current_time - this->calibration_start_time) / 1e6 >= CALIBRATION_TIMEOUT) {
+            this->calibration_state = MotorCalibrationState::FAILED;
+            this->raise_error(MotorControllerError::CALIBRATION_FAILED);
+        }
+    }
+}
+
+void MotorController::report_ready_time(uint32_t current_time)
+{
+    if (this->ready_time != 0.0)
+        return;
+
+    this->ready_time = (current_time - this->boot_time) / 1e6;
+    Serial.print("Motor ready after ");
+    Serial.print(this->ready_time.load());
+    Serial.println(" s");
+}
+
+void MotorController::send_command(MotorCommandType type, float value)
+{
+    if (this->commands == nullptr)
+        return;
+
+    MotorCommand command = {type, value, this->command_sequence++};
+    xQueueOverwrite(this->commands, &command);
+}
+
+void MotorController::queue_command(const MotorCommand &command)
+{
+    // Only the newest setpoint matters, whatever its type.
+    for (int i = 0; i < (int)MotorCommandType::COUNT; i++) {
+        if (this->command_cache[i].pending) {
+            this->command_cache[i].pending = false;
+            this->command_cache[i].suppressed_count++;
+        }
+    }
+
+    if (command.type == MotorCommandType::VELOCITY) {
+        // Coming out of torque control, the profile starts from the measured velocity.
+        if (this->active_command_type != MotorCommandType::VELOCITY) {
+            this->trajectory.reset(this->velocity * -GEARBOX_RATIO / 60.0);
+            this->command_cache[(int)MotorCommandType::VELOCITY].pending = true;
+            this->command_cache[(int)MotorCommandType::VELOCITY].pending_value = this->trajectory.get_velocity();
+        }
+        this->trajectory.set_target(command.value);
+        return;
+    } else {
+        // Stop the profile, otherwise its next point would switch the ODrive back to velocity
+        // control.
+        this->trajectory.reset(this->trajectory.get_velocity());
+    }
+
+    MotorCommandCache &cache = this->command_cache[(int)command.type];
+    cache.pending = true;
+    cache.pending_value = command.value;
+}
+
+void MotorController::stop()
+{
+    for (int i = 0; i < (int)MotorCommandType::COUNT; i++)
+        this->command_cache[i].pending = false;
+    this->trajectory.reset(0.0);
+    this->write_command(MotorCommandType::VELOCITY, 0.0);
+}
+
+void MotorController::update_trajectory(uint32_t current_time)
+{
+    if (this->trajectory.is_settled())
+        return;
+
+    // Intermediate points replace each other silently, the deadband and rate limit decide which
+    // of them are written.
+    MotorCommandCache &cache = this->command_cache[(int)MotorCommandType::VELOCITY];
+    cache.pending = true;
+    cache.pending_value = this->trajectory.update((current_time - this->last_step_time) / 1e6);
+}
+
+void MotorController::flush_commands()
+{
+    uint32_t current_time = micros();
+    for (int i = 0; i < (int)MotorCommandType::COUNT; i++) {
+        MotorCommandCache &cache = this->command_cache[i];
+        if (!cache.pending)
+            continue;
+
+        MotorCommandType type = (MotorCommandType)i;
+        bool stopping = cache.pending_value == 0.0 && cache.value != 0.0;
+        if (type == this->active_command_type && cache.valid && !stopping && fabs(cache.pending_value - cache.value) <= cache.deadband) {
+            cache.pending = false;
+            cache.suppressed_count++;
+            continue;
         }
-        //TODO
-        if (this->read_error() != 0)
-           this->set_error((float)MotorControllerError::CONTROL_ERROR);
+
+        // Held back setpoints stay pending and are written once the interval has passed, unless a
+        // newer one replaces them first. Stopping the motor is never delayed.
+        if (!stopping && type == this->active_command_type && cache.valid && (current_time - cache.time) / 1e6 < cache.min_interval)
+            continue;
+
+        this->write_command(type, cache.pending_value);
     }
 }
 
+void MotorController::write_command(MotorCommandType type, float value)
+{
+    if (type == MotorCommandType::VELOCITY)
+        this->write_velocity(value);
+    else
+        this->write_torque(value);
+
+    MotorCommandCache &cache = this->command_cache[(int)type];
+    cache.value = value;
+    cache.time = micros();
+    cache.valid = true;
+    cache.pending = false;
+    this->active_command_type = type;
+}
+
+void MotorController::publish_state()
+{
+    MotorState state = {this->position, this->velocity, this->torque, this->error, this->calibration_state};
+    this->state.write(state);
+}
+
+void MotorController::raise_error(MotorControllerError error)
+{
+    this->error = error;
+}
+
 void MotorController::mode_changed(ServiceMode mode)
 {
-    this->set_velocity(0.0);
+    this->stop_sequence = this->command_sequence++;
+    this->stop_requested = true;
 }
 
 void MotorController::set_velocity(float velocity)
 {
-    this->write_velocity(velocity * -GEARBOX_RATIO / 60.0);
+    this->send_command(MotorCommandType::VELOCITY, velocity * -GEARBOX_RATIO / 60.0);
 }
 
 void MotorController::set_torque(float torque)
 {
-    this->write_torque(-torque);
+    this->send_command(MotorCommandType::TORQUE, -torque);
 }
 
 float MotorController::get_velocity()
 {
-    return this->velocity;
+    return this->state.read().velocity;
 }
 
 float MotorController::get_position()
 {
-    return this->position;
+    return this->state.read().position;
 }
 
 float MotorController::get_torque()
 {
-    return this->torque;
+    return this->state.read().torque;
 }
 
 void MotorController::set_error(float error)
@@ -142,77 +443,176 @@ void MotorController::set_error(float error)
     //if (this->error != MotorControllerError::NONE && error != MotorControllerError::NONE)
     //    return;
     // if previous error is none or new error is none
-    int int_error = (int)error;
-    this->error = MotorControllerError(int_error);
+    // Applied by the motor task on its next cycle.
+    this->pending_error = (int)error;
 }
 
 float MotorController::get_error()
 {
-    return (float)this->error;
+    return (float)this->state.read().error;
 }
 
-String MotorController::wait_for_response()
+float MotorController::get_calibration_state()
 {
-    if (this->error == MotorControllerError::NOT_RESPONDING)
-        return "";
+    return (float)this->state.read().calibration_state;
+}
 
-    uint32_t start_time = millis();
-    String response = this->serial->readStringUntil('\n');
-    if (millis() - start_time > 1000u)
-        this->set_error((float)MotorControllerError::NOT_RESPONDING);
-    
-    return response;
+void MotorController::request_feedback()
+{
+    if (this->polling_mode == MotorPollingMode::PIPELINED) {
+        this->transport.request_feedback();
+        return;
+    }
+
+    static const ODriveProperty SEQUENCE[] = {
+        ODriveProperty::POSITION,
+        ODriveProperty::VELOCITY,
+        ODriveProperty::IQ_SETPOINT,
+    };
+    this->transport.request(SEQUENCE[this->poll_index]);
+    this->poll_index = (this->poll_index + 1) % (sizeof(SEQUENCE) / sizeof(SEQUENCE[0]));
 }
 
-void MotorController::write_state(int state)
+void MotorController::read_feedback()
 {
-    this->serial->printf("w axis0.requested_state %i\n", state);
+    float value;
+    if (this->transport.get_response(ODriveProperty::POSITION, &value))
+        this->position = value * -1.0 / GEARBOX_RATIO;
+
+    if (this->transport.get_response(ODriveProperty::VELOCITY, &value))
+        this->velocity = value * -60.0 / GEARBOX_RATIO;
+
+    if (this->transport.get_response(ODriveProperty::IQ_SETPOINT, &value)) {
+        uint32_t current_time = micros();
+        float dt = (current_time - this->last_torque_time) / 1e6;
+        this->last_torque_time = current_time;
+
+        float torque = value * -TORQUE_CONSTANT;
+        float alpha = exp(-6.0 * dt);
+        this->torque = (1.0 - alpha) * torque + alpha * this->torque;
+        this->update_feedback_rate(current_time);
+    }
 }
 
-int MotorController::read_state()
+void MotorController::request_health(uint32_t current_time)
 {
-    this->serial->printf("r axis0.current_state\n");
-    return this->wait_for_response().toInt();
+    float elapsed = (current_time - this->last_health_time) / 1e6;
+    bool fault = this->error == MotorControllerError::CONTROL_ERROR || this->health_fault_count > 0;
+    float interval = fault ? FAULT_HEALTH_POLL_INTERVAL : HEALTH_POLL_INTERVAL;
+    uint32_t timeout_count = this->transport.get_timeout_count();
+    if (elapsed < interval && timeout_count == this->health_timeout_count)
+        return;
+
+    if (this->transport.request_health()) {
+        this->last_health_time = current_time;
+        this->health_timeout_count = timeout_count;
+    }
 }
 
-void MotorController::write_torque(float torque)
+void MotorController::read_health()
 {
-    this->serial->printf("c 0 %f\n", torque);
+    // The transport hands over both values of a health burst together, or neither.
+    float state, result;
+    bool state_received = this->transport.get_response(ODriveProperty::CURRENT_STATE, &state);
+    bool result_received = this->transport.get_response(ODriveProperty::PROCEDURE_RESULT, &result);
+    if (!state_received || !result_received)
+        return;
+
+    bool fault = (AxisState)state != AxisState::CLOSED_LOOP_CONTROL || this->check_procedure_result((int)result) != 0;
+    this->health_fault_count = fault ? this->health_fault_count + 1 : 0;
+    if (this->health_fault_count >= HEALTH_FAULT_SAMPLES && this->error == MotorControllerError::NONE)
+        this->raise_error(MotorControllerError::CONTROL_ERROR);
 }
 
-float MotorController::read_torque()
+void MotorController::check_responding()
 {
-    this->serial->printf("r axis0.motor.foc.Iq_setpoint\n");
-    return this->wait_for_response().toFloat();
+    bool responding = this->transport.is_responding();
+    if (!responding && this->error != MotorControllerError::NOT_RESPONDING)
+        this->raise_error(MotorControllerError::NOT_RESPONDING);
+    else if (responding && this->error == MotorControllerError::NOT_RESPONDING)
+        this->raise_error(MotorControllerError::NONE);
 }
 
-void MotorController::write_velocity(float velocity)
+void MotorController::write_state(int state)
 {
-    this->serial->printf("v 0 %f\n", velocity);
+    this->transport.write(ODriveProperty::REQUESTED_STATE, (float)state);
 }
 
-float MotorController::read_velocity()
+void MotorController::write_torque(float torque)
 {
-    this->serial->printf("r axis0.vel_estimate\n");
-    return this->wait_for_response().toFloat();
+    this->transport.write_torque(torque);
 }
 
-float MotorController::read_position()
+void MotorController::write_velocity(float velocity)
 {
-    this->serial->printf("r axis0.pos_estimate\n");
-    return this->wait_for_response().toFloat();
+    this->transport.write_velocity(velocity);
 }
 
-int MotorController::read_error()
+int MotorController::check_procedure_result(int result)
 {
-    this->serial->printf("r axis0.procedure_result\n");
-    int result = this->wait_for_response().toInt();
-    Serial.print("motor error: ");
-    Serial.println(result);
+    if (result != this->procedure_result) {
+        Serial.print("motor error: ");
+        Serial.println(result);
+        this->procedure_result = result;
+    }
     return result == 1 || result == 0 ? 0 : result;
 }
 
 bool MotorController::is_ok()
 {
-    return this->error == MotorControllerError::NONE;
+    return this->state.read().error == MotorControllerError::NONE;
+}
+
+void MotorController::set_polling_mode(MotorPollingMode mode)
+{
+    this->polling_mode = mode;
+}
+
+float MotorController::get_feedback_rate()
+{
+    return this->feedback_rate;
+}
+
+float MotorController::get_ready_time()
+{
+    return this->ready_time;
+}
+
+void MotorController::set_command_limits(MotorCommandType type, float deadband, float max_rate)
+{
+    this->command_cache[(int)type].deadband = deadband;
+    this->command_cache[(int)type].min_interval = 1.0 / max_rate;
+}
+
+uint32_t MotorController::get_suppressed_commands(MotorCommandType type)
+{
+    return this->command_cache[(int)type].suppressed_count;
+}
+
+void MotorController::set_trajectory_limits(float max_acceleration, float max_jerk)
+{
+    this->trajectory.set_limits(max_acceleration, max_jerk);
+}
+
+void MotorController::set_trajectory_stop_limits(float max_acceleration, float max_jerk)
+{
+    this->trajectory.set_stop_limits(max_acceleration, max_jerk);
+}
+
+void MotorController::update_feedback_rate(uint32_t current_time)
+{
+    this->feedback_count++;
+    float elapsed = (current_time - this->feedback_rate_start) / 1e6;
+    if (elapsed < FEEDBACK_RATE_INTERVAL)
+        return;
+
+    this->feedback_rate = this->feedback_count / elapsed;
+    this->feedback_count = 0;
+    this->feedback_rate_start = current_time;
+#if DEBUG_MODE
+    Serial.print(">Motor feedback rate: ");
+    Serial.println(this->feedback_rate.load());
+    Serial.print(">Motor suppressed commands: ");
+    Serial.println(this->command_cache[(int)MotorCommandType::VELOCITY].suppressed_count + this->command_cache[(int)MotorCommandType::TORQUE].suppressed_count);
+#endif
 }
\ No newline at end of file
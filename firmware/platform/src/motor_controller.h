@@ -17,7 +17,11 @@
 
 #pragma once
 #include <Arduino.h>
+#include <atomic>
 #include "peripheral.h"
+#include "seqlock.h"
+#include "velocity_trajectory.h"
+#include "odrive_ascii_transport.h"
 
 enum class MotorControllerError {
     NONE,
@@ -27,9 +31,58 @@ enum class MotorControllerError {
     NEEDS_RECALIBRATION,
 };
 
+enum class MotorCalibrationState {
+    READY,
+    STARTING,
+    CHECKING_CALIBRATION,
+    CALIBRATING,
+    ENTERING_CLOSED_LOOP,
+    FAILED,
+};
+
+enum class MotorPollingMode {
+    SEQUENTIAL,
+    PIPELINED,
+};
+
+enum class MotorCommandType {
+    VELOCITY,
+    TORQUE,
+    COUNT
+};
+
+// Commands are numbered as they are sent, so the motor task can tell whether one was sent
+// before or after a stop.
+struct MotorCommand {
+    MotorCommandType type;
+    float value;
+    uint32_t sequence;
+};
+
+// Last setpoint written to the ODrive for one command type, used to drop writes that would not
+// change anything and to limit how often the UART is used for setpoints.
+struct MotorCommandCache {
+    float deadband;
+    float min_interval;
+    float value;
+    uint32_t time;
+    bool valid;
+    bool pending;
+    float pending_value;
+    std::atomic<uint32_t> suppressed_count;
+};
+
+struct MotorState {
+    float position;
+    float velocity;
+    float torque;
+    MotorControllerError error;
+    MotorCalibrationState calibration_state;
+};
+
 class MotorController: public Peripheral {
 public:
-    MotorController(const char *position_uuid, const char *velocity_uuid, const char *torque_uuid, const char *error_uuid, HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin);
+    MotorController(const char *position_uuid, const char *velocity_uuid, const char *torque_uuid, const char *error_uuid, const char *calibration_uuid, HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin);
 
     void start() override;
 
@@ -51,8 +104,24 @@ public:
 
     float get_error();
 
+    float get_calibration_state();
+
     bool is_ok();
 
+    void set_polling_mode(MotorPollingMode mode);
+
+    float get_feedback_rate();
+
+    float get_ready_time();
+
+    void set_command_limits(MotorCommandType type, float deadband, float max_rate);
+
+    uint32_t get_suppressed_commands(MotorCommandType type);
+
+    void set_trajectory_limits(float max_acceleration, float max_jerk);
+
+    void set_trajectory_stop_limits(float max_acceleration, float max_jerk);
+
 private:
     HardwareSerial *serial;
     int32_t rx_pin;
@@ -60,24 +129,86 @@ private:
     float position;
     float velocity;
     float torque;
-    uint32_t last_update_time;
     MotorControllerError error;
+    MotorCalibrationState calibration_state;
+    uint32_t calibration_time;
+    uint32_t calibration_start_time;
+    bool reused_calibration;
+    uint32_t boot_time;
+    std::atomic<float> ready_time;
+    MotorPollingMode polling_mode;
+    int poll_index;
+    uint32_t last_torque_time;
+    uint32_t feedback_count;
+    uint32_t feedback_rate_start;
+    std::atomic<float> feedback_rate;
+    std::atomic<int> pending_error;
+    std::atomic<bool> stop_requested;
+    std::atomic<uint32_t> command_sequence;
+    std::atomic<uint32_t> stop_sequence;
+    Seqlock<MotorState> state;
+    QueueHandle_t commands;
+    MotorCommandCache command_cache[(int)MotorCommandType::COUNT];
+    MotorCommandType active_command_type;
+    VelocityTrajectory trajectory;
+    uint32_t last_step_time;
+    uint32_t last_health_time;
+    uint32_t health_timeout_count;
+    int health_fault_count;
+    int procedure_result;
+    TaskHandle_t task;
 
-    String wait_for_response();
+    ODriveAsciiTransport transport;
 
-    void write_state(int state);
+    static void task_entry(void *parameter);
 
-    int read_state();
+    void run();
 
-    void write_torque(float torque);
+    void step();
 
-    float read_torque();
+    void send_command(MotorCommandType type, float value);
 
-    void write_velocity(float velocity);
+    void queue_command(const MotorCommand &command);
+
+    void stop();
+
+    void update_trajectory(uint32_t current_time);
+
+    void flush_commands();
+
+    void write_command(MotorCommandType type, float value);
+
+    void publish_state();
+
+    void raise_error(MotorControllerError error);
+
+    void set_calibration_state(MotorCalibrationState state);
+
+    void run_calibration(int procedure);
+
+    void enter_closed_loop();
 
-    float read_velocity();
+    void update_calibration();
 
-    float read_position();
+    void report_ready_time(uint32_t current_time);
+
+    void request_feedback();
+
+    void read_feedback();
+
+    void request_health(uint32_t current_time);
+
+    void read_health();
+
+    void check_responding();
+
+    void update_feedback_rate(uint32_t current_time);
+
+    void write_state(int state);
+
+    void write_torque(float torque);
+
+    void write_velocity(float velocity);
 
-    int read_error();
+    int check_procedure_result(int result);
 };
\ No newline at end of file
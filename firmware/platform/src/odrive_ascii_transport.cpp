@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "odrive_ascii_transport.h"
+
+static const float REQUEST_TIMEOUT = 0.05;
+static const uint32_t MAX_CONSECUTIVE_TIMEOUTS = 5;
+static const int MAX_BYTES_PER_UPDATE = 64;
+static const int TX_BUFFER_SIZE = 256;
+// After a lost or mismatched reply, received lines are ignored until the link has been quiet for
+// this long, so late replies can't be matched to the next requests.
+static const float RESYNC_TIME = 0.05;
+
+struct ODrivePropertyInfo {
+    const char *path;
+    bool integer;
+};
+
+static const ODrivePropertyInfo PROPERTIES[(int)ODriveProperty::COUNT] = {
+    {"axis0.current_state", true},
+    {"axis0.requested_state", true},
+    {"axis0.controller.config.control_mode", true},
+    {"axis0.pos_estimate", false},
+    {"axis0.vel_estimate", false},
+    {"axis0.motor.foc.Iq_setpoint", false},
+    {"axis0.procedure_result", true},
+    {"axis0.controller.input_vel", false},
+    {"axis0.controller.input_torque", false},
+    {"axis0.config.motor.phase_resistance_valid", true},
+    {"axis0.commutation_mapper.config.offset_valid", true},
+};
+
+ODriveAsciiTransport::ODriveAsciiTransport()
+{
+    this->serial = nullptr;
+    this->request_count = 0;
+    this->timeout_count = 0;
+    this->consecutive_timeouts = 0;
+    for (int i = 0; i < (int)ODriveProperty::COUNT; i++) {
+        this->responses[i] = 0.0;
+        this->response_ready[i] = false;
+    }
+    this->line_length = 0;
+    this->line_overflow = false;
+    this->held_count = 0;
+    this->resyncing = false;
+    this->resync_time = 0;
+}
+
+void ODriveAsciiTransport::begin(HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin)
+{
+    this->serial = serial;
+    // A TX buffer lets command writes return immediately instead of waiting on the UART FIFO.
+    this->serial->setTxBufferSize(TX_BUFFER_SIZE);
+    this->serial->begin(BAUD_RATE, SERIAL_8N1, rx_pin, tx_pin);
+    while (!this->serial);
+    this->serial->onReceive(std::bind(&ODriveAsciiTransport::on_receive, this));
+}
+
+void ODriveAsciiTransport::update()
+{
+    uint8_t byte;
+    for (int i = 0; i < MAX_BYTES_PER_UPDATE && this->rx_buffer.pop(&byte); i++)
+        this->parse(byte);
+
+    uint32_t current_time = micros();
+    for (int i = 0; i < this->request_count; i++) {
+        if ((int32_t)(current_time - this->requests[i].deadline) < 0)
+            continue;
+
+        this->remove_request(i--);
+        this->timeout_count++;
+        this->consecutive_timeouts++;
+        this->on_timeout();
+    }
+}
+
+bool ODriveAsciiTransport::get_response(ODriveProperty property, float *value)
+{
+    if (!this->response_ready[(int)property])
+        return false;
+
+    *value = this->responses[(int)property];
+    this->response_ready[(int)property] = false;
+    return true;
+}
+
+bool ODriveAsciiTransport::is_responding()
+{
+    return this->consecutive_timeouts < MAX_CONSECUTIVE_TIMEOUTS;
+}
+
+uint32_t ODriveAsciiTransport::get_timeout_count()
+{
+    return this->timeout_count;
+}
+
+const char *ODriveAsciiTransport::get_path(ODriveProperty property)
+{
+    return PROPERTIES[(int)property].path;
+}
+
+bool ODriveAsciiTransport::is_integer(ODriveProperty property)
+{
+    return PROPERTIES[(int)property].integer;
+}
+
+bool ODriveAsciiTransport::add_request(ODriveProperty property, bool combined)
+{
+    if (this->request_count >= ODRIVE_MAX_PENDING_REQUESTS)
+        return false;
+
+    ODriveRequest *request = &this->requests[this->request_count++];
+    request->property = property;
+    request->deadline = micros() + (uint32_t)(REQUEST_TIMEOUT * 1e6);
+    request->combined = combined;
+    return true;
+}
+
+void ODriveAsciiTransport::remove_request(int index)
+{
+    for (int i = index; i < this->request_count - 1; i++)
+        this->requests[i] = this->requests[i + 1];
+    this->request_count--;
+}
+
+void ODriveAsciiTransport::complete(ODriveProperty property, float value)
+{
+    this->responses[(int)property] = value;
+    this->response_ready[(int)property] = true;
+    this->consecutive_timeouts = 0;
+}
+
+void ODriveAsciiTransport::on_receive()
+{
+    while (this->serial->available() > 0)
+        this->rx_buffer.push(this->serial->read());
+}
+
+void ODriveAsciiTransport::write(ODriveProperty property, float value)
+{
+    if (ODriveAsciiTransport::is_integer(property))
+        this->serial->printf("w %s %i\n", ODriveAsciiTransport::get_path(property), (int)value);
+    else
+        this->serial->printf("w %s %f\n", ODriveAsciiTransport::get_path(property), value);
+}
+
+bool ODriveAsciiTransport::request(ODriveProperty property)
+{
+    if (!this->add_request(property))
+        return false;
+
+    this->serial->printf("r %s\n", ODriveAsciiTransport::get_path(property));
+    return true;
+}
+
+void ODriveAsciiTransport::write_velocity(float velocity)
+{
+    this->serial->printf("v 0 %f\n", velocity);
+}
+
+void ODriveAsciiTransport::write_torque(float torque)
+{
+    this->serial->printf("c 0 %f\n", torque);
+}
+
+bool ODriveAsciiTransport::request_feedback()
+{
+    if (this->request_count + 2 > ODRIVE_MAX_PENDING_REQUESTS)
+        return false;
+
+    // "f 0" replies with "<pos> <vel>" on a single line.
+    this->add_request(ODriveProperty::POSITION, true);
+    this->add_request(ODriveProperty::IQ_SETPOINT);
+    this->serial->print("f 0\nr axis0.motor.foc.Iq_setpoint\n");
+    return true;
+}
+
+bool ODriveAsciiTransport::request_health()
+{
+    if (this->request_count + 2 > ODRIVE_MAX_PENDING_REQUESTS)
+        return false;
+
+    this->add_request(ODriveProperty::CURRENT_STATE);
+    this->add_request(ODriveProperty::PROCEDURE_RESULT);
+    this->serial->print("r axis0.current_state\nr axis0.procedure_result\n");
+    return true;
+}
+
+bool ODriveAsciiTransport::is_idle()
+{
+    if (this->resyncing && (micros() - this->resync_time) / 1e6 >= RESYNC_TIME)
+        this->resyncing = false;
+    return !this->resyncing && this->request_count == 0;
+}
+
+void ODriveAsciiTransport::parse(uint8_t byte)
+{
+    if (byte == '\r')
+        return;
+
+    if (byte != '\n') {
+        if (this->line_length < ODRIVE_MAX_LINE_LENGTH - 1)
+            this->line[this->line_length++] = byte;
+        else
+            this->line_overflow = true;
+        return;
+    }
+
+    this->line[this->line_length] = '\0';
+    if (!this->line_overflow)
+        this->parse_line();
+    this->line_length = 0;
+    this->line_overflow = false;
+}
+
+void ODriveAsciiTransport::on_timeout()
+{
+    // ASCII replies carry no sequence number and are matched in order, so once one is lost the
+    // replies already matched may belong to other requests.
+    this->drop_burst();
+    this->line_length = 0;
+    this->line_overflow = false;
+}
+
+void ODriveAsciiTransport::drop_burst()
+{
+    this->request_count = 0;
+    this->held_count = 0;
+    this->resyncing = true;
+    this->resync_time = micros();
+}
+
+void ODriveAsciiTransport::hold(ODriveProperty property, float value)
+{
+    this->held[this->held_count].property = property;
+    this->held[this->held_count].value = value;
+    this->held_count++;
+}
+
+void ODriveAsciiTransport::parse_line()
+{
+    if (this->resyncing) {
+        this->resync_time = micros();
+        return;
+    }
+    if (this->request_count == 0)
+        return;
+
+    ODriveRequest request = this->requests[0];
+    this->remove_request(0);
+
+    // A reply that doesn't have the shape of the request it is matched to means one was lost.
+    char *end;
+    float value = strtof(this->line, &end);
+    char *velocity_end;
+    float velocity = strtof(end, &velocity_end);
+    bool has_velocity = velocity_end != end;
+    if (end == this->line || has_velocity != request.combined) {
+        this->drop_burst();
+        return;
+    }
+
+    if (request.combined)
+        this->hold(ODriveProperty::VELOCITY, velocity);
+    this->hold(request.property, value);
+    if (this->request_count > 0)
+        return;
+
+    for (int i = 0; i < this->held_count; i++)
+        this->complete(this->held[i].property, this->held[i].value);
+    this->held_count = 0;
+}
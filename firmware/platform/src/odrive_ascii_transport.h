@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "ring_buffer.h"
+
+#define ODRIVE_MAX_LINE_LENGTH 64
+
+#define ODRIVE_MAX_PENDING_REQUESTS 8
+
+enum class ODriveProperty {
+    CURRENT_STATE,
+    REQUESTED_STATE,
+    CONTROL_MODE,
+    POSITION,
+    VELOCITY,
+    IQ_SETPOINT,
+    PROCEDURE_RESULT,
+    INPUT_VELOCITY,
+    INPUT_TORQUE,
+    MOTOR_CALIBRATED,
+    ENCODER_CALIBRATED,
+    COUNT
+};
+
+struct ODriveReply {
+    ODriveProperty property;
+    float value;
+};
+
+struct ODriveRequest {
+    ODriveProperty property;
+    uint32_t deadline;
+    bool combined;
+};
+
+// Non-blocking link to the ODrive over its ASCII protocol. Received bytes are queued by the UART
+// receive callback and parsed in update(), which matches replies against the outstanding request
+// table and expires requests that pass their deadline. Replies are picked up with get_response().
+class ODriveAsciiTransport {
+public:
+    ODriveAsciiTransport();
+
+    void begin(HardwareSerial *serial, int32_t rx_pin, int32_t tx_pin);
+
+    void update();
+
+    void write(ODriveProperty property, float value);
+
+    bool request(ODriveProperty property);
+
+    void write_velocity(float velocity);
+
+    void write_torque(float torque);
+
+    bool request_feedback();
+
+    bool request_health();
+
+    bool get_response(ODriveProperty property, float *value);
+
+    bool is_idle();
+
+    bool is_responding();
+
+    uint32_t get_timeout_count();
+
+    static const char *get_path(ODriveProperty property);
+
+    static bool is_integer(ODriveProperty property);
+
+private:
+    void parse(uint8_t byte);
+
+    void parse_line();
+
+    void on_timeout();
+
+    bool add_request(ODriveProperty property, bool combined = false);
+
+    void remove_request(int index);
+
+    void complete(ODriveProperty property, float value);
+
+    void hold(ODriveProperty property, float value);
+
+    void drop_burst();
+
+    void on_receive();
+
+    HardwareSerial *serial;
+    RingBuffer rx_buffer;
+    ODriveRequest requests[ODRIVE_MAX_PENDING_REQUESTS];
+    int request_count;
+    float responses[(int)ODriveProperty::COUNT];
+    bool response_ready[(int)ODriveProperty::COUNT];
+    uint32_t timeout_count;
+    uint32_t consecutive_timeouts;
+    char line[ODRIVE_MAX_LINE_LENGTH];
+    int line_length;
+    bool line_overflow;
+    // Replies are held until every outstanding request has been answered, one reply for each
+    // request plus the velocity of a combined feedback reply.
+    ODriveReply held[ODRIVE_MAX_PENDING_REQUESTS * 2];
+    int held_count;
+    bool resyncing;
+    uint32_t resync_time;
+};
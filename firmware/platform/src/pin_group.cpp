@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <soc/gpio_struct.h>
+#include "pin_group.h"
+
+PinGroup::PinGroup()
+{
+    this->pin_count = 0;
+    for (int i = 0; i < PIN_GROUP_MAX_STATES; i++) {
+        this->masks[i] = {{0, 0}, {0, 0}};
+        this->defined[i] = false;
+    }
+    this->state = -1;
+}
+
+void PinGroup::add_pin(int32_t pin)
+{
+    if (this->pin_count < PIN_GROUP_MAX_PINS)
+        this->pins[this->pin_count++] = pin;
+}
+
+void PinGroup::define_state(int state, uint32_t levels)
+{
+    if (state < 0 || state >= PIN_GROUP_MAX_STATES)
+        return;
+
+    PinGroupMasks masks = {{0, 0}, {0, 0}};
+    for (int i = 0; i < this->pin_count; i++) {
+        int32_t pin = this->pins[i];
+        if (pin < 0)
+            continue;
+        uint32_t bit = 1u << (pin % 32);
+        if (levels & (1u << i))
+            masks.set[pin / 32] |= bit;
+        else
+            masks.clear[pin / 32] |= bit;
+    }
+    this->masks[state] = masks;
+    this->defined[state] = true;
+}
+
+void PinGroup::start()
+{
+    for (int i = 0; i < this->pin_count; i++) {
+        if (this->pins[i] >= 0)
+            pinMode(this->pins[i], OUTPUT);
+    }
+    this->state = -1;
+}
+
+// Returns false for a state that was never defined. The registers are only written when the state
+// changes. Within a port the clear and set writes land one bus cycle apart, and pins on different
+// ports one write apart; GPIO.out is not rewritten whole since that would race with digitalWrite
+// on the other core.
+bool PinGroup::apply(int state)
+{
+    if (state < 0 || state >= PIN_GROUP_MAX_STATES || !this->defined[state])
+        return false;
+    if (state == this->state)
+        return true;
+
+    const PinGroupMasks &masks = this->masks[state];
+    if (masks.clear[0])
+        GPIO.out_w1tc = masks.clear[0];
+    if (masks.set[0])
+        GPIO.out_w1ts = masks.set[0];
+    if (masks.clear[1])
+        GPIO.out1_w1tc.val = masks.clear[1];
+    if (masks.set[1])
+        GPIO.out1_w1ts.val = masks.set[1];
+    this->state = state;
+    return true;
+}
+
+int PinGroup::get_state()
+{
+    return this->state;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define PIN_GROUP_MAX_PINS 4
+#define PIN_GROUP_MAX_STATES 8
+#define PIN_GROUP_PORTS 2
+
+// Set and clear masks for GPIO 0-31 and GPIO 32-39.
+struct PinGroupMasks {
+    uint32_t set[PIN_GROUP_PORTS];
+    uint32_t clear[PIN_GROUP_PORTS];
+};
+
+// Output pins switched together between predefined states. Each state is a pair of masks per
+// port, so applying one is a write to the port's clear register and one to its set register
+// instead of a digitalWrite per pin. Pins are added before the states are defined, and bit i of a
+// state's levels is the level of the i-th pin. Negative pins are ignored.
+class PinGroup {
+public:
+    PinGroup();
+
+    void add_pin(int32_t pin);
+
+    void define_state(int state, uint32_t levels);
+
+    void start();
+
+    bool apply(int state);
+
+    int get_state();
+
+private:
+    int32_t pins[PIN_GROUP_MAX_PINS];
+    int pin_count;
+    PinGroupMasks masks[PIN_GROUP_MAX_STATES];
+    bool defined[PIN_GROUP_MAX_STATES];
+    int state;
+};
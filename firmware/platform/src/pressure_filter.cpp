@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pressure_filter.h"
+
+PressureFilter::PressureFilter()
+{
+    this->configure(1, 1, 0.0);
+}
+
+void PressureFilter::configure(int oversampling, int median_size, float time_constant)
+{
+    this->oversampling = constrain(oversampling, 1, PRESSURE_FILTER_MAX_OVERSAMPLING);
+    this->median_size = constrain(median_size, 1, PRESSURE_FILTER_MAX_MEDIAN);
+    this->time_constant = max(0.0f, time_constant);
+    this->reset();
+}
+
+// Returns true when the sample completed an oversampling group and the outputs were updated. The
+// group is timestamped with its first sample.
+bool PressureFilter::add(float value, uint32_t time)
+{
+    if (this->oversample_count == 0)
+        this->oversample_time = time;
+    this->oversample_sum += value;
+    if (++this->oversample_count < this->oversampling)
+        return false;
+
+    float average = this->oversample_sum / this->oversample_count;
+    this->oversample_sum = 0.0;
+    this->oversample_count = 0;
+
+    this->median_values[this->median_index] = average;
+    this->median_index = (this->median_index + 1) % this->median_size;
+    this->median_count = min(this->median_count + 1, this->median_size);
+
+    float sorted[PRESSURE_FILTER_MAX_MEDIAN];
+    for (int i = 0; i < this->median_count; i++) {
+        float value = this->median_values[i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = value;
+    }
+    this->despiked = sorted[this->median_count / 2];
+
+    float dt = (this->oversample_time - this->time) / 1e6;
+    if (!this->has_output || this->time_constant <= 0.0) {
+        this->output = this->despiked;
+    } else {
+        float alpha = exp(-dt / this->time_constant);
+        this->output = this->output * alpha + this->despiked * (1.0 - alpha);
+    }
+    this->time = this->oversample_time;
+    this->has_output = true;
+    return true;
+}
+
+float PressureFilter::get_despiked()
+{
+    return this->despiked;
+}
+
+float PressureFilter::get_output()
+{
+    return this->output;
+}
+
+uint32_t PressureFilter::get_time()
+{
+    return this->time;
+}
+
+void PressureFilter::reset()
+{
+    this->oversample_sum = 0.0;
+    this->oversample_count = 0;
+    this->oversample_time = 0;
+    this->median_index = 0;
+    this->median_count = 0;
+    this->despiked = 0.0;
+    this->output = 0.0;
+    this->time = 0;
+    this->has_output = false;
+}
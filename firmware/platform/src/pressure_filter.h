@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define PRESSURE_FILTER_MAX_OVERSAMPLING 8
+#define PRESSURE_FILTER_MAX_MEDIAN 9
+
+// Pressure filter pipeline: averages each group of `oversampling` raw samples into one, takes the
+// median of the last `median_size` averages to drop spikes, then low-passes the result. All
+// buffers are fixed size. Oversampling divides the output rate, so raise the sample rate with it.
+class PressureFilter {
+public:
+    PressureFilter();
+
+    void configure(int oversampling, int median_size, float time_constant);
+
+    bool add(float value, uint32_t time);
+
+    float get_despiked();
+
+    float get_output();
+
+    uint32_t get_time();
+
+    void reset();
+
+private:
+    int oversampling;
+    int median_size;
+    float time_constant;
+    float oversample_sum;
+    int oversample_count;
+    uint32_t oversample_time;
+    float median_values[PRESSURE_FILTER_MAX_MEDIAN];
+    int median_index;
+    int median_count;
+    float despiked;
+    float output;
+    uint32_t time;
+    bool has_output;
+};
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pressure_history.h"
+
+PressureHistory::PressureHistory()
+{
+    this->clear();
+}
+
+void PressureHistory::push(float pressure, uint32_t time)
+{
+    this->head = (this->head + 1) % PRESSURE_HISTORY_SIZE;
+    this->samples[this->head] = {pressure, time};
+    if (this->count < PRESSURE_HISTORY_SIZE)
+        this->count++;
+}
+
+int PressureHistory::size()
+{
+    return this->count;
+}
+
+// Age 0 is the newest sample.
+PressureSample PressureHistory::get(int age)
+{
+    return this->samples[(this->head - age + PRESSURE_HISTORY_SIZE) % PRESSURE_HISTORY_SIZE];
+}
+
+// Slope of the least-squares line through the newest samples, in pressure units per second.
+// With evenly spaced samples this is the first-order Savitzky-Golay derivative, using the
+// timestamps keeps it correct when a sample comes in late.
+float PressureHistory::get_derivative(int window)
+{
+    int n = min(window, this->count);
+    if (n < 2)
+        return 0.0;
+
+    uint32_t newest_time = this->get(0).time;
+    float mean_time = 0.0;
+    float mean_pressure = 0.0;
+    for (int i = 0; i < n; i++) {
+        PressureSample sample = this->get(i);
+        mean_time += -(float)(newest_time - sample.time) / 1e6;
+        mean_pressure += sample.pressure;
+    }
+    mean_time /= n;
+    mean_pressure /= n;
+
+    float covariance = 0.0;
+    float variance = 0.0;
+    for (int i = 0; i < n; i++) {
+        PressureSample sample = this->get(i);
+        float time = -(float)(newest_time - sample.time) / 1e6 - mean_time;
+        covariance += time * (sample.pressure - mean_pressure);
+        variance += time * time;
+    }
+    return variance > 0.0 ? covariance / variance : 0.0;
+}
+
+void PressureHistory::clear()
+{
+    this->head = 0;
+    this->count = 0;
+}
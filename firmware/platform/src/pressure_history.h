@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define PRESSURE_HISTORY_SIZE 32
+
+struct PressureSample {
+    float pressure;
+    uint32_t time;
+};
+
+// Most recent pressure samples with their timestamps, oldest overwritten first.
+class PressureHistory {
+public:
+    PressureHistory();
+
+    void push(float pressure, uint32_t time);
+
+    int size();
+
+    PressureSample get(int age);
+
+    float get_derivative(int window);
+
+    void clear();
+
+private:
+    PressureSample samples[PRESSURE_HISTORY_SIZE];
+    int head;
+    int count;
+};
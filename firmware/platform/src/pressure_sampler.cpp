@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pressure_sampler.h"
+
+static const uint32_t CONVERSION_TIME_MS = 5;
+static const int MAX_CONVERSION_POLLS = 5;
+static const float SAMPLE_RATE_INTERVAL = 1.0;
+// A pair is out of date once this many samples in a row have failed to replace it.
+static const uint32_t MAX_MISSED_SAMPLES = 5;
+// Core 1 is taken by the Arduino loop and the motor task, the sampler mostly sleeps waiting for
+// conversions so it shares core 0 with the BLE host.
+static const BaseType_t SAMPLER_TASK_CORE = 0;
+static const UBaseType_t SAMPLER_TASK_PRIORITY = 2;
+static const uint32_t SAMPLER_TASK_STACK_SIZE = 3072;
+
+PressureSampler::PressureSampler(PressureSensor *sensor1, PressureSensor *sensor2)
+{
+    this->sensors[0] = sensor1;
+    this->sensors[1] = sensor2;
+    this->pair.write({0.0, 0.0, 0, false});
+    this->sample_rate = 0.0;
+    this->sample_count = 0;
+    this->sample_rate_start = 0;
+    this->task = nullptr;
+}
+
+// Must run after both sensors' start(), which set up the buses.
+void PressureSampler::start()
+{
+    for (int i = 0; i < 2; i++)
+        this->sensors[i]->set_external_sampling(true);
+
+    this->sample_rate_start = micros();
+    xTaskCreatePinnedToCore(&PressureSampler::task_entry, "pressure", SAMPLER_TASK_STACK_SIZE, this, SAMPLER_TASK_PRIORITY, &this->task, SAMPLER_TASK_CORE);
+}
+
+void PressureSampler::task_entry(void *parameter)
+{
+    ((PressureSampler *)parameter)->run();
+}
+
+// Runs at the first sensor's sample rate, read again for every pair so set_sample_rate() applies
+// while running. A pair that takes longer than the period starts the next one right away.
+void PressureSampler::run()
+{
+    TickType_t wake_time = xTaskGetTickCount();
+    while (true) {
+        this->sample();
+        TickType_t period = max((TickType_t)1, pdMS_TO_TICKS(this->sensors[0]->get_sample_period() / 1000));
+        vTaskDelayUntil(&wake_time, period);
+    }
+}
+
+void PressureSampler::sample()
+{
+    PressureConversion conversions[2] = {PressureConversion::FAILED, PressureConversion::FAILED};
+    float psi[2];
+
+    uint32_t sample_time = micros();
+    for (int i = 0; i < 2; i++) {
+        if (this->sensors[i]->is_connected() && this->sensors[i]->start_conversion())
+            conversions[i] = PressureConversion::BUSY;
+    }
+    vTaskDelay(pdMS_TO_TICKS(CONVERSION_TIME_MS));
+
+    for (int poll = 0; poll < MAX_CONVERSION_POLLS; poll++) {
+        bool busy = false;
+        for (int i = 0; i < 2; i++) {
+            if (conversions[i] == PressureConversion::BUSY)
+                conversions[i] = this->sensors[i]->read_conversion(&psi[i]);
+            busy = busy || conversions[i] == PressureConversion::BUSY;
+        }
+        if (!busy)
+            break;
+        vTaskDelay(1);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if (conversions[i] == PressureConversion::READY)
+            this->sensors[i]->add_sample(psi[i], sample_time);
+    }
+
+    if (conversions[0] != PressureConversion::READY || conversions[1] != PressureConversion::READY)
+        return;
+
+    this->pair.write({this->sensors[0]->get_pressure(), this->sensors[1]->get_pressure(), sample_time, true});
+
+    this->sample_count++;
+    float elapsed = (sample_time - this->sample_rate_start) / 1e6;
+    if (elapsed >= SAMPLE_RATE_INTERVAL) {
+        this->sample_rate = this->sample_count / elapsed;
+        this->sample_count = 0;
+        this->sample_rate_start = sample_time;
+    }
+}
+
+PressurePair PressureSampler::get_pair()
+{
+    return this->pair.read();
+}
+
+// The time between pairs is the sample period plus up to the conversion time.
+bool PressureSampler::is_recent(const PressurePair &pair)
+{
+    uint32_t max_age = (MAX_MISSED_SAMPLES + 1) * (this->sensors[0]->get_sample_period() + CONVERSION_TIME_MS * 1000);
+    return pair.valid && micros() - pair.time <= max_age;
+}
+
+float PressureSampler::get_sample_rate()
+{
+    return this->sample_rate;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "peripheral.h"
+#include "pressure_sensor.h"
+#include "seqlock.h"
+
+// Both pressures from the same sampling instant. A pair is only published when both conversions
+// succeed, so valid is false until the first one is.
+struct PressurePair {
+    float pressure1;
+    float pressure2;
+    uint32_t time;
+    bool valid;
+};
+
+// Samples two pressure sensors on separate I2C buses from a dedicated task. Both conversions are
+// started together and collected together, so they overlap instead of running back to back, and
+// the sensors' own update() no longer touches the buses.
+class PressureSampler: public Peripheral {
+public:
+    PressureSampler(PressureSensor *sensor1, PressureSensor *sensor2);
+
+    void start() override;
+
+    PressurePair get_pair();
+
+    bool is_recent(const PressurePair &pair);
+
+    float get_sample_rate();
+
+private:
+    PressureSensor *sensors[2];
+    Seqlock<PressurePair> pair;
+    std::atomic<float> sample_rate;
+    uint32_t sample_count;
+    uint32_t sample_rate_start;
+    TaskHandle_t task;
+
+    static void task_entry(void *parameter);
+
+    void run();
+
+    void sample();
+};
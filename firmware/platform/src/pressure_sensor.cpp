@@ -17,23 +17,93 @@
 
 #include <Arduino.h>
 #include "pressure_sensor.h"
+#include "settings.h"
 
+static const uint8_t MPRLS_ADDRESS = 0x18;
+static const uint8_t MPRLS_STATUS_BUSY = 0x20;
+static const uint8_t MPRLS_STATUS_INTEGRITY_FAIL = 0x04;
+static const uint8_t MPRLS_STATUS_MATH_SATURATION = 0x01;
+// Conversions take about 5 ms, polling earlier would only find the sensor busy.
+static const float MPRLS_CONVERSION_TIME = 0.005;
+// Transfer function of the 0-25 psi part, the output spans 10% to 90% of 2^24 counts.
+static const float MPRLS_OUTPUT_MIN = 0x19999A;
+static const float MPRLS_OUTPUT_MAX = 0xE66666;
+static const float MPRLS_PSI_MIN = 0.0;
+static const float MPRLS_PSI_MAX = 25.0;
+// Sampling runs at a fixed rate so that filtering and the derivative don't depend on how busy
+// the loop is. The derivative is fitted over the last 9 filter outputs (80 ms at 100 Hz).
+static const float DEFAULT_SAMPLE_RATE = 100.0;
+// By default a median of 5 removes spikes from vacuum turbulence up to two samples long, for two
+// samples of delay, before the low-pass and the derivative see them.
+static const int DEFAULT_OVERSAMPLING = 1;
+static const int DEFAULT_MEDIAN_SIZE = 5;
+static const float DEFAULT_FILTER_TIME_CONSTANT = 0.035;
+static const int DERIVATIVE_WINDOW = 9;
+// Samples outside the sensor's range or changing faster than any inflation can are dropped. After
+// a few in a row the new level is accepted, since the pressure may really have moved meanwhile.
+static const float MAX_PRESSURE_RATE = 100.0;
+static const int MAX_CONSECUTIVE_REJECTIONS = 5;
+// A stuck bus is recovered by clocking out the byte a slave may be holding SDA low for, sending
+// a STOP and restarting the I2C driver. That takes about 150 us and is retried at most twice a
+// second while the bus stays down.
+static const int MAX_CONSECUTIVE_FAILURES = 5;
+static const float BUS_RECOVERY_INTERVAL = 0.5;
+static const int BUS_RECOVERY_CLOCK_PULSES = 9;
+static const uint32_t BUS_RECOVERY_HALF_PERIOD_US = 5;
+// A transfer with the MPRLS takes well under a millisecond. The default 50 ms Wire timeout would
+// stall the control loop that samples inline whenever the sensor stops answering.
+static const uint16_t I2C_TIMEOUT_MS = 3;
+// The zero offset is the mean reading over a settled stretch while the caller says the line is
+// at rest. Settled means the filtered reading stayed within a band over the whole stretch: the
+// 9-point derivative of a resting sensor is mostly noise (about 13 times the sample noise), so it
+// cannot tell a settled line from jitter. At the 0.003 psi sample noise of the MPRLS the default
+// filter's output spans at most 0.008 psi over two seconds, a slow leak of 0.0075 psi/s already
+// leaves the band. The offset is saved to NVS when it moves by more than the threshold, so a boot
+// can use it straight away.
+static const float OFFSET_MAX_SPREAD = 0.015;
+static const float OFFSET_SETTLE_TIME = 2.0;
+static const float OFFSET_SAVE_THRESHOLD = 0.005;
 
-PressureSensor::PressureSensor(const char *pressure_uuid, const char *error_uuid, TwoWire* wire, int32_t SCL_pin, int32_t SDA_pin)
+PressureSensor::PressureSensor(const char *pressure_uuid, const char *error_uuid, const char *rejected_uuid, const char *failed_transfers_uuid, const char *bus_recoveries_uuid, const char *offset_key, TwoWire* wire, int32_t SCL_pin, int32_t SDA_pin)
 {
     this->clock_pin = SCL_pin;
     this->data_pin = SDA_pin;
     this->wire = wire;
     this->last_psi = 14.7;
-    this->moving_pressure = 0.0;
-    this->moving_squared_pressure = 0.0;
     this->pressure_derivative = 0.0;
+    this->external_sampling = false;
+    this->converting = false;
+    this->conversion_time = 0;
+    this->last_sample_time = 0;
+    this->next_sample_time = 0;
+    this->set_sample_rate(DEFAULT_SAMPLE_RATE);
+    this->set_filter(DEFAULT_OVERSAMPLING, DEFAULT_MEDIAN_SIZE, DEFAULT_FILTER_TIME_CONSTANT);
+    this->trace = false;
+    this->has_sample = false;
+    this->consecutive_rejections = 0;
+    this->consecutive_failures = 0;
+    this->recovery_time = 0;
+    this->rejected_samples = 0;
+    this->failed_transfers = 0;
+    this->bus_recoveries = 0;
     this->pressure_offset = 0.0;
     this->calibrating = false;
+    this->offset_key = offset_key;
+    this->saved_offset = 0.0;
+    this->offset_sum = 0.0;
+    this->offset_count = 0;
+    this->offset_min = 0.0;
+    this->offset_max = 0.0;
+    this->offset_start_time = 0;
+    this->offset_sample_time = 0;
     this->error = PressureSensorError::NONE;
+    this->reading.write({0.0, 0.0, 0});
 
     this->add_characteristic(pressure_uuid, nullptr, std::bind(&PressureSensor::get_pressure, this));
     this->add_characteristic(error_uuid, nullptr, std::bind(&PressureSensor::get_error, this));
+    this->add_characteristic(rejected_uuid, nullptr, std::bind(&PressureSensor::get_rejected_samples, this));
+    this->add_characteristic(failed_transfers_uuid, nullptr, std::bind(&PressureSensor::get_failed_transfers, this));
+    this->add_characteristic(bus_recoveries_uuid, nullptr, std::bind(&PressureSensor::get_bus_recoveries, this));
 }
 
 void PressureSensor::start()
@@ -45,6 +115,16 @@ void PressureSensor::start()
         this->error = PressureSensorError::NOT_CONNECTED;
         Serial.println("Failed to communicate with pressure sensor, check wiring?");
     }
+    this->wire->setTimeOut(I2C_TIMEOUT_MS);
+    this->converting = false;
+    this->last_sample_time = micros();
+    this->next_sample_time = this->last_sample_time;
+    this->history.clear();
+
+    Settings::begin();
+    this->pressure_offset = Settings::get_float(this->offset_key, 0.0);
+    this->saved_offset = this->pressure_offset;
+    this->offset_start_time = micros();
 }
 
 void PressureSensor::update(float dt)
@@ -53,45 +133,211 @@ void PressureSensor::update(float dt)
     if (this->error == PressureSensorError::NOT_CONNECTED)
         return;
 
-    float psi = this->read_psi();
-    // float psi_diff = abs(psi-this->last_psi);
-    // if (this->error == PressureSensorError::NONE && psi_diff > 10.0)
-    //     this->error = PressureSensorError::NOT_CONNECTED;
-    //else if (this->error == PressureSensorError::NOT_CONNECTED && psi_diff <= 10.0)
-    //    this->error = PressureSensorError::NONE;
+    if (!this->external_sampling)
+        this->sample();
 
-    float alpha = 0.75;
+    this->update_offset(this->reading.read());
+}
 
-    float previous_moving_pressure = this->moving_pressure;
-    this->moving_pressure = this->moving_pressure * alpha + psi * (1.0 - alpha);
-    this->moving_squared_pressure = this->moving_squared_pressure * alpha + psi * psi * (1.0 - alpha);
+void PressureSensor::update_offset(const PressureReading &reading)
+{
+    uint32_t current_time = micros();
+    if (!this->calibrating) {
+        this->offset_count = 0;
+        return;
+    }
 
-    this->pressure_derivative = (this->moving_pressure - previous_moving_pressure) / dt;
+    if (this->offset_count > 0 && reading.time == this->offset_sample_time)
+        return;
+    this->offset_sample_time = reading.time;
 
-    if (this->calibrating && abs(this->pressure_derivative) <= 0.01) {
-        this->pressure_offset = this->moving_pressure;
+    // Restart the stretch from this sample when it is the first or leaves the band.
+    this->offset_min = min(this->offset_min, reading.pressure);
+    this->offset_max = max(this->offset_max, reading.pressure);
+    if (this->offset_count == 0 || this->offset_max - this->offset_min > OFFSET_MAX_SPREAD) {
+        this->offset_sum = 0.0;
+        this->offset_count = 0;
+        this->offset_min = reading.pressure;
+        this->offset_max = reading.pressure;
+        this->offset_start_time = current_time;
     }
 
-    //float std = sqrt(max(0.0f, this->moving_squared_pressure - this->moving_pressure * this->moving_pressure));
-    
+    this->offset_sum += reading.pressure;
+    this->offset_count++;
+    if ((current_time - this->offset_start_time) / 1e6 < OFFSET_SETTLE_TIME)
+        return;
+
+    this->pressure_offset = this->offset_sum / this->offset_count;
+    this->offset_count = 0;
+    if (abs(this->pressure_offset - this->saved_offset) > OFFSET_SAVE_THRESHOLD && Settings::put_float(this->offset_key, this->pressure_offset))
+        this->saved_offset = this->pressure_offset;
+}
+
+// The conversion is started on one update and collected on a later one, instead of waiting for it
+// in readPressure(). Conversions start on a fixed schedule and the sample is timestamped with the
+// time its conversion started.
+void PressureSensor::sample()
+{
+    uint32_t current_time = micros();
+    if (!this->converting) {
+        if ((int32_t)(current_time - this->next_sample_time) < 0)
+            return;
+
+        this->next_sample_time += this->sample_period;
+        if ((int32_t)(current_time - this->next_sample_time) >= 0)
+            this->next_sample_time = current_time + this->sample_period;
+        this->converting = this->start_conversion();
+        this->conversion_time = current_time;
+        return;
+    }
+
+    if ((current_time - this->conversion_time) / 1e6 < MPRLS_CONVERSION_TIME)
+        return;
+
+    float psi;
+    PressureConversion conversion = this->read_conversion(&psi);
+    if (conversion == PressureConversion::BUSY)
+        return;
+
+    this->converting = false;
+    if (conversion == PressureConversion::READY)
+        this->add_sample(psi, this->conversion_time);
+}
+
+// Called from the task that owns the sensor's bus, readers only see the published reading.
+void PressureSensor::add_sample(float psi, uint32_t time)
+{
+    float sample_dt = (time - this->last_sample_time) / 1e6;
+    if (!this->validate(psi, sample_dt))
+        return;
+    this->last_sample_time = time;
+
     this->last_psi = psi;
+    if (this->trace)
+        Serial.printf("%.6f,%.5f\n", time / 1e6, psi);
+
+    if (this->filter_changed.exchange(false)) {
+        this->filter.configure(this->filter_oversampling, this->filter_median_size, this->filter_time_constant);
+        this->history.clear();
+    }
+    if (!this->filter.add(psi, time))
+        return;
+
+    // The derivative is fitted to the despiked samples, the low-pass would only add lag to it.
+    this->history.push(this->filter.get_despiked(), this->filter.get_time());
+    this->pressure_derivative = this->history.get_derivative(DERIVATIVE_WINDOW);
+
+    this->reading.write({this->filter.get_output(), this->pressure_derivative, this->filter.get_time()});
 }
 
-float PressureSensor::read_psi()
+bool PressureSensor::validate(float psi, float dt)
 {
-    float pressure_hPa = this->sensor.readPressure();
-    return pressure_hPa / 68.947572932;
+    bool valid = isfinite(psi) && psi >= MPRLS_PSI_MIN && psi <= MPRLS_PSI_MAX;
+    if (valid && this->has_sample && this->consecutive_rejections < MAX_CONSECUTIVE_REJECTIONS)
+        valid = abs(psi - this->last_psi) <= MAX_PRESSURE_RATE * dt;
+
+    if (!valid) {
+        this->rejected_samples++;
+        this->consecutive_rejections++;
+        return false;
+    }
+
+    this->has_sample = true;
+    this->consecutive_rejections = 0;
+    return true;
+}
+
+bool PressureSensor::start_conversion()
+{
+    if (this->error == PressureSensorError::BUS_RECOVERY) {
+        if ((micros() - this->recovery_time) / 1e6 < BUS_RECOVERY_INTERVAL)
+            return false;
+        this->recover_bus();
+    }
+
+    this->wire->beginTransmission(MPRLS_ADDRESS);
+    this->wire->write(0xAA);
+    this->wire->write(0x00);
+    this->wire->write(0x00);
+    bool ok = this->wire->endTransmission() == 0;
+    this->record_transfer(ok);
+    return ok;
+}
+
+void PressureSensor::record_transfer(bool ok)
+{
+    if (ok) {
+        this->consecutive_failures = 0;
+        if (this->error == PressureSensorError::BUS_RECOVERY)
+            this->error = PressureSensorError::NONE;
+        return;
+    }
+
+    this->failed_transfers++;
+    this->consecutive_failures++;
+    if (this->consecutive_failures >= MAX_CONSECUTIVE_FAILURES && this->error == PressureSensorError::NONE) {
+        this->error = PressureSensorError::BUS_RECOVERY;
+        this->recovery_time = micros() - (uint32_t)(BUS_RECOVERY_INTERVAL * 1e6);
+    }
+}
+
+void PressureSensor::recover_bus()
+{
+    this->wire->end();
+    pinMode(this->data_pin, INPUT_PULLUP);
+    pinMode(this->clock_pin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(this->clock_pin, HIGH);
+    for (int i = 0; i < BUS_RECOVERY_CLOCK_PULSES && digitalRead(this->data_pin) == LOW; i++) {
+        digitalWrite(this->clock_pin, LOW);
+        delayMicroseconds(BUS_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(this->clock_pin, HIGH);
+        delayMicroseconds(BUS_RECOVERY_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA rising while SCL is high.
+    pinMode(this->data_pin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(this->data_pin, LOW);
+    delayMicroseconds(BUS_RECOVERY_HALF_PERIOD_US);
+    digitalWrite(this->data_pin, HIGH);
+    delayMicroseconds(BUS_RECOVERY_HALF_PERIOD_US);
+
+    this->wire->begin(this->data_pin, this->clock_pin);
+    this->wire->setTimeOut(I2C_TIMEOUT_MS);
+    this->converting = false;
+    this->bus_recoveries++;
+    this->recovery_time = micros();
+}
+
+PressureConversion PressureSensor::read_conversion(float *psi)
+{
+    uint8_t data[4];
+    bool ok = this->wire->requestFrom(MPRLS_ADDRESS, (uint8_t)4) == 4;
+    this->record_transfer(ok);
+    if (!ok)
+        return PressureConversion::FAILED;
+    for (int i = 0; i < 4; i++)
+        data[i] = this->wire->read();
+
+    uint8_t status = data[0];
+    if (status & MPRLS_STATUS_BUSY)
+        return PressureConversion::BUSY;
+    if (status & (MPRLS_STATUS_INTEGRITY_FAIL | MPRLS_STATUS_MATH_SATURATION))
+        return PressureConversion::FAILED;
+
+    uint32_t raw = ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+    *psi = (raw - MPRLS_OUTPUT_MIN) * (MPRLS_PSI_MAX - MPRLS_PSI_MIN) / (MPRLS_OUTPUT_MAX - MPRLS_OUTPUT_MIN) + MPRLS_PSI_MIN;
+    return PressureConversion::READY;
 }
 
 float PressureSensor::get_pressure()
 {
     //return this->read_psi() - this->pressure_offset;
-    return this->moving_pressure - this->pressure_offset;
+    return this->reading.read().pressure - this->pressure_offset;
 }
 
 float PressureSensor::get_derivative()
 {
-    return this->pressure_derivative;
+    return this->reading.read().derivative;
 }
 
 bool PressureSensor::is_ok()
@@ -104,7 +350,58 @@ void PressureSensor::set_calibrating(bool calibrating)
     this->calibrating = calibrating;
 }
 
+bool PressureSensor::is_connected()
+{
+    return this->error != PressureSensorError::NOT_CONNECTED;
+}
+
 float PressureSensor::get_error()
 {
     return (float)this->error;
+}
+
+uint32_t PressureSensor::get_rejected_samples()
+{
+    return this->rejected_samples;
+}
+
+uint32_t PressureSensor::get_failed_transfers()
+{
+    return this->failed_transfers;
+}
+
+uint32_t PressureSensor::get_bus_recoveries()
+{
+    return this->bus_recoveries;
+}
+
+void PressureSensor::set_external_sampling(bool external_sampling)
+{
+    this->external_sampling = external_sampling;
+}
+
+void PressureSensor::set_sample_rate(float sample_rate)
+{
+    this->sample_period = (uint32_t)(1e6 / sample_rate);
+}
+
+// Prints every sample that passes validation as "time_s,psi", the trace format read by
+// tools/pressure_filter_report.cpp.
+void PressureSensor::set_trace(bool trace)
+{
+    this->trace = trace;
+}
+
+// Takes effect from the next sample in the sampling task, which restarts the filter.
+void PressureSensor::set_filter(int oversampling, int median_size, float time_constant)
+{
+    this->filter_oversampling = oversampling;
+    this->filter_median_size = median_size;
+    this->filter_time_constant = time_constant;
+    this->filter_changed = true;
+}
+
+uint32_t PressureSensor::get_sample_period()
+{
+    return this->sample_period;
 }
\ No newline at end of file
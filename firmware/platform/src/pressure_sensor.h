@@ -17,17 +17,34 @@
 
 #pragma once
 #include <Adafruit_MPRLS.h>
+#include <atomic>
 #include "peripheral.h"
+#include "seqlock.h"
+#include "pressure_history.h"
+#include "pressure_filter.h"
 
 
 enum PressureSensorError {
     NONE,
-    NOT_CONNECTED
+    NOT_CONNECTED,
+    BUS_RECOVERY
+};
+
+enum class PressureConversion {
+    READY,
+    BUSY,
+    FAILED,
+};
+
+struct PressureReading {
+    float pressure;
+    float derivative;
+    uint32_t time;
 };
 
 class PressureSensor: public Peripheral {
 public:
-    PressureSensor(const char *pressure_uuid, const char *error_uuid, TwoWire* wire, int32_t SCL_pin, int32_t SDA_pin);
+    PressureSensor(const char *pressure_uuid, const char *error_uuid, const char *rejected_uuid, const char *failed_transfers_uuid, const char *bus_recoveries_uuid, const char *offset_key, TwoWire* wire, int32_t SCL_pin, int32_t SDA_pin);
 
     void start() override;
 
@@ -39,22 +56,81 @@ public:
 
     bool is_ok();
 
+    bool is_connected();
+
     void set_calibrating(bool calibrating);
 
     float get_error();
+
+    uint32_t get_rejected_samples();
+
+    uint32_t get_failed_transfers();
+
+    uint32_t get_bus_recoveries();
+
+    void set_external_sampling(bool external_sampling);
+
+    void set_sample_rate(float sample_rate);
+
+    void set_filter(int oversampling, int median_size, float time_constant);
+
+    void set_trace(bool trace);
+
+    uint32_t get_sample_period();
+
+    bool start_conversion();
+
+    PressureConversion read_conversion(float *psi);
+
+    void add_sample(float psi, uint32_t time);
     
     float pressure_offset;
 private:
-    float read_psi();
+    void sample();
+
+    void update_offset(const PressureReading &reading);
+
+    bool validate(float psi, float dt);
+
+    void record_transfer(bool ok);
+
+    void recover_bus();
 
     Adafruit_MPRLS sensor;
     TwoWire* wire;
     int32_t clock_pin;
     int32_t data_pin;
     float last_psi;
-    float moving_pressure;
-    float moving_squared_pressure;
     float pressure_derivative;
     bool calibrating;
+    const char *offset_key;
+    float saved_offset;
+    float offset_sum;
+    int offset_count;
+    float offset_min;
+    float offset_max;
+    uint32_t offset_start_time;
+    uint32_t offset_sample_time;
+    bool external_sampling;
+    bool converting;
+    uint32_t conversion_time;
+    uint32_t last_sample_time;
+    std::atomic<uint32_t> sample_period;
+    uint32_t next_sample_time;
+    PressureHistory history;
+    PressureFilter filter;
+    int filter_oversampling;
+    int filter_median_size;
+    float filter_time_constant;
+    std::atomic<bool> filter_changed;
+    bool trace;
+    bool has_sample;
+    int consecutive_rejections;
+    int consecutive_failures;
+    uint32_t recovery_time;
+    std::atomic<uint32_t> rejected_samples;
+    std::atomic<uint32_t> failed_transfers;
+    std::atomic<uint32_t> bus_recoveries;
+    Seqlock<PressureReading> reading;
     PressureSensorError error;
-};
\ No newline at end of file
+};
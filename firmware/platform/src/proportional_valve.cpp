@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "proportional_valve.h"
+#include "config.h"
+
+static const uint32_t PWM_FREQUENCY = 1000;
+static const uint8_t PWM_RESOLUTION_BITS = 16;
+static const uint32_t PWM_MAX_DUTY = (1 << PWM_RESOLUTION_BITS) - 1;
+// Opening per psi above the reference, per psi second, and per psi/s of pressure rise.
+static const float Kp = 0.5;
+static const float Ki = 1.0;
+static const float Kd = 0.05;
+
+ProportionalValve::ProportionalValve(const char *opening_uuid, const char *on_off_uuid, const char *reference_uuid, PressureSensor *sensor, int32_t pwm_pin, int32_t ledc_channel, int32_t on_off_pin)
+{
+    this->sensor = sensor;
+    this->pwm_pin = pwm_pin;
+    this->ledc_channel = ledc_channel;
+    this->on_off_output.add_pin(on_off_pin);
+    this->on_off_output.define_state(LOW, LOW);
+    this->on_off_output.define_state(HIGH, HIGH);
+    this->opening = 0.0;
+    this->on = false;
+    this->pressure_reference = 0.0;
+    this->integral = 0.0;
+    this->duty = UINT32_MAX;
+
+    this->add_characteristic(opening_uuid, std::bind(&ProportionalValve::set_opening, this, std::placeholders::_1), std::bind(&ProportionalValve::get_opening, this));
+    this->add_characteristic(on_off_uuid, std::bind(&ProportionalValve::set_on, this, std::placeholders::_1), std::bind(&ProportionalValve::get_on, this));
+    if (sensor != nullptr)
+        this->add_characteristic(reference_uuid, std::bind(&ProportionalValve::set_reference, this, std::placeholders::_1), std::bind(&ProportionalValve::get_reference, this));
+}
+
+void ProportionalValve::start()
+{
+    pinMode(this->pwm_pin, OUTPUT);
+    ledcSetup(this->ledc_channel, PWM_FREQUENCY, PWM_RESOLUTION_BITS);
+    ledcAttachPin(this->pwm_pin, this->ledc_channel);
+    this->on_off_output.start();
+    this->duty = UINT32_MAX;
+    this->write_opening();
+    this->set_on(this->on);
+}
+
+// Closed loop: the valve opens further while the pressure is above the reference and rising. The
+// integral is clamped to the valve's range so it can't wind up while the valve is saturated.
+void ProportionalValve::update(float dt)
+{
+    Peripheral::update(dt);
+    if (this->pressure_reference == 0.0 || this->sensor == nullptr || !this->on)
+        return;
+
+    float error = this->sensor->get_pressure() - this->pressure_reference;
+    this->integral = constrain(this->integral + Ki * error * dt, 0.0, 1.0);
+    this->opening = constrain(Kp * error + this->integral + Kd * this->sensor->get_derivative(), 0.0, 1.0);
+    this->write_opening();
+}
+
+void ProportionalValve::mode_changed(ServiceMode mode)
+{
+    this->set_reference(0.0);
+    this->set_opening(0.0);
+    this->set_on(0.0);
+}
+
+// Setting the opening directly leaves closed-loop control.
+void ProportionalValve::set_opening(float opening)
+{
+    this->pressure_reference = 0.0;
+    this->opening = constrain(opening, 0.0, 1.0);
+    this->write_opening();
+}
+
+float ProportionalValve::get_opening()
+{
+    return this->opening;
+}
+
+void ProportionalValve::set_on(float on)
+{
+    this->on = on != 0.0;
+    this->on_off_output.apply(this->on ? HIGH : LOW);
+}
+
+float ProportionalValve::get_on()
+{
+    return this->on ? 1.0 : 0.0;
+}
+
+// A reference of 0 leaves closed-loop control with the valve where it is. Starting from the
+// current opening avoids a jump.
+void ProportionalValve::set_reference(float reference)
+{
+    if (this->sensor == nullptr)
+        return;
+    if (reference != 0.0 && this->pressure_reference == 0.0)
+        this->integral = this->opening;
+    this->pressure_reference = max(reference, 0.0f);
+}
+
+float ProportionalValve::get_reference()
+{
+    return this->pressure_reference;
+}
+
+// Only writes to the LEDC peripheral when the duty changes.
+void ProportionalValve::write_opening()
+{
+    uint32_t duty = (uint32_t)(this->opening * PWM_MAX_DUTY);
+    if (duty == this->duty)
+        return;
+    ledcWrite(this->ledc_channel, duty);
+    this->duty = duty;
+}
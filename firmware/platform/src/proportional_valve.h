@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include "peripheral.h"
+#include "pressure_sensor.h"
+#include "pin_group.h"
+
+// Proportional bleed valve driven with LEDC PWM, in series with an on/off valve. The opening can be
+// set directly, or trimmed against a pressure reference when a sensor is given. Bleeding air
+// changes the pressure much faster than the vacuum's dimmer can.
+class ProportionalValve: public Peripheral {
+public:
+    ProportionalValve(const char *opening_uuid, const char *on_off_uuid, const char *reference_uuid, PressureSensor *sensor, int32_t pwm_pin, int32_t ledc_channel, int32_t on_off_pin);
+
+    void start() override;
+
+    void update(float dt) override;
+
+    void mode_changed(ServiceMode mode) override;
+
+    void set_opening(float opening);
+
+    float get_opening();
+
+    void set_on(float on);
+
+    float get_on();
+
+    void set_reference(float reference);
+
+    float get_reference();
+
+private:
+    void write_opening();
+
+    PressureSensor *sensor;
+    int32_t pwm_pin;
+    int32_t ledc_channel;
+    PinGroup on_off_output;
+    float opening;
+    bool on;
+    float pressure_reference;
+    float integral;
+    uint32_t duty;
+};
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ring_buffer.h"
+
+RingBuffer::RingBuffer()
+{
+    this->head = 0;
+    this->tail = 0;
+    this->overflow_count = 0;
+}
+
+bool RingBuffer::push(uint8_t value)
+{
+    uint32_t head = this->head.load(std::memory_order_relaxed);
+    if (head - this->tail.load(std::memory_order_acquire) >= RING_BUFFER_SIZE) {
+        this->overflow_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    this->data[head % RING_BUFFER_SIZE] = value;
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool RingBuffer::pop(uint8_t *value)
+{
+    uint32_t tail = this->tail.load(std::memory_order_relaxed);
+    if (tail == this->head.load(std::memory_order_acquire))
+        return false;
+
+    *value = this->data[tail % RING_BUFFER_SIZE];
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+size_t RingBuffer::available()
+{
+    return this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_relaxed);
+}
+
+void RingBuffer::clear()
+{
+    this->tail.store(this->head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint32_t RingBuffer::get_overflow_count()
+{
+    return this->overflow_count.load(std::memory_order_relaxed);
+}
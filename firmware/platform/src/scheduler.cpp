@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "scheduler.h"
+
+static ScheduledAction actions[MAX_SCHEDULED_ACTIONS];
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Returns false if every slot is taken. The delay is in seconds.
+bool Scheduler::schedule(float delay, std::function<void()> action, const void *owner)
+{
+    ScheduledAction *slot = nullptr;
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < MAX_SCHEDULED_ACTIONS && slot == nullptr; i++) {
+        if (actions[i].state == ScheduledActionState::FREE) {
+            slot = &actions[i];
+            slot->state = ScheduledActionState::RESERVED;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    if (slot == nullptr)
+        return false;
+
+    // The std::function may allocate, so it is assigned outside the critical section.
+    slot->action = action;
+    slot->owner = owner;
+    slot->time = micros() + (uint32_t)(max(delay, 0.0f) * 1e6);
+    portENTER_CRITICAL(&lock);
+    slot->state = ScheduledActionState::PENDING;
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+// Drops the owner's pending actions. One that is already running still finishes.
+void Scheduler::cancel(const void *owner)
+{
+    portENTER_CRITICAL(&lock);
+    for (int i = 0; i < MAX_SCHEDULED_ACTIONS; i++) {
+        if (actions[i].state == ScheduledActionState::PENDING && actions[i].owner == owner)
+            actions[i].state = ScheduledActionState::FREE;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void Scheduler::run()
+{
+    uint32_t current_time = micros();
+    for (int i = 0; i < MAX_SCHEDULED_ACTIONS; i++) {
+        ScheduledAction *slot = &actions[i];
+        portENTER_CRITICAL(&lock);
+        bool due = slot->state == ScheduledActionState::PENDING && (int32_t)(current_time - slot->time) >= 0;
+        if (due)
+            slot->state = ScheduledActionState::RUNNING;
+        portEXIT_CRITICAL(&lock);
+        if (!due)
+            continue;
+
+        slot->action();
+        slot->action = nullptr;
+        portENTER_CRITICAL(&lock);
+        slot->state = ScheduledActionState::FREE;
+        portEXIT_CRITICAL(&lock);
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+#define MAX_SCHEDULED_ACTIONS 16
+
+enum class ScheduledActionState {
+    FREE,
+    RESERVED,
+    PENDING,
+    RUNNING,
+};
+
+struct ScheduledAction {
+    std::function<void()> action;
+    const void *owner;
+    uint32_t time;
+    ScheduledActionState state;
+};
+
+// Actions deferred by a delay instead of waiting in delay(). Service::update() runs the due ones
+// at the start of each tick, on the loop task. Actions can be scheduled and cancelled from BLE
+// callbacks too; the table is locked only to change slot states, never while an action runs.
+class Scheduler {
+public:
+    static bool schedule(float delay, std::function<void()> action, const void *owner);
+
+    static void cancel(const void *owner);
+
+    static void run();
+};
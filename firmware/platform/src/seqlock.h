@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+
+// Sequence lock for publishing a small value from one writer task to any number of readers
+// without blocking either side. Readers retry if the writer was mid-update.
+template <typename T>
+class Seqlock {
+public:
+    Seqlock()
+    {
+        this->sequence = 0;
+    }
+
+    void write(const T &value)
+    {
+        uint32_t sequence = this->sequence.load(std::memory_order_relaxed);
+        this->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        this->value = value;
+        std::atomic_thread_fence(std::memory_order_release);
+        this->sequence.store(sequence + 2, std::memory_order_relaxed);
+    }
+
+    T read() const
+    {
+        T value;
+        uint32_t before, after;
+        do {
+            before = this->sequence.load(std::memory_order_acquire);
+            value = this->value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = this->sequence.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1));
+        return value;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+};
@@ -17,6 +17,7 @@
 
 #include <Arduino.h>
 #include "service.h"
+#include "scheduler.h"
 #include "config.h"
 #include "common/uuids.h"
 
@@ -68,6 +69,7 @@ void Service::update()
     uint32_t current_time = micros();
     float dt = max(1e-10, (current_time - this->last_update_time) / 1e6);
     
+    Scheduler::run();
     for (int i = 0; i < this->peripheral_count; i++)
         this->peripherals[i]->update(dt);
     
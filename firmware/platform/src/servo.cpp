@@ -20,51 +20,110 @@
 
 static const float MAX_MICROSECONDS = 2500.0;
 static const float MIN_MICROSECONDS = 500.0;
-static const float SERVO_UPDATE_INTERVAL = 0.2;
+// The profile is stepped at a fixed rate, catching up at most a few steps after a slow loop.
+static const float SERVO_UPDATE_INTERVAL = 0.01;
+static const int MAX_CATCH_UP_STEPS = 5;
+static const float DEFAULT_MAX_VELOCITY = 90.0;
+static const float DEFAULT_MAX_ACCELERATION = 360.0;
 
 Servo::Servo(const char *angle_uuid, int32_t pwm_pin, int32_t ledc_channel)
 {
     this->pwm_pin = pwm_pin;
     this->ledc_channel = ledc_channel;
     this->angle = SERVO_ANGLE1;
+    this->goal_angle = SERVO_ANGLE1;
+    this->velocity = 0.0;
+    this->duty = UINT32_MAX;
+    this->set_motion_limits(DEFAULT_MAX_VELOCITY, DEFAULT_MAX_ACCELERATION);
 
     this->add_characteristic(angle_uuid, std::bind(&Servo::set_angle, this, std::placeholders::_1), std::bind(&Servo::get_angle, this));
 }
 
+// The servo's position is unknown at boot, so it is sent straight to the first angle.
 void Servo::start()
 {
     pinMode(this->pwm_pin, OUTPUT);
     ledcSetup(this->ledc_channel, 400, 16);
     ledcAttachPin(this->pwm_pin, this->ledc_channel);
-    this->set_angle(SERVO_ANGLE1);
+    this->goal_angle = SERVO_ANGLE1;
+    this->angle = SERVO_ANGLE1;
+    this->velocity = 0.0;
+    this->duty = UINT32_MAX;
+    this->write_angle();
     this->last_update_time = micros();
-
 }
 
 void Servo::update(float dt)
 {
     Peripheral::update(dt);
 
+    uint32_t interval = (uint32_t)(SERVO_UPDATE_INTERVAL * 1e6);
     uint32_t current_time = micros();
-    if (current_time - this->last_update_time > (uint32_t)(SERVO_UPDATE_INTERVAL * 1e6)) {
-        dt = (current_time - this->last_update_time) / 1e6;
-        this->last_update_time = current_time;
-        // Slow transition:
-        // if (this->goal_angle != this->angle){
-        //     this->angle = (this->goal_angle-this->angle)>0 ? this->angle+1 : this->angle-1;
-        //     this->set_angle(this->angle);
-        // }
+    if (current_time - this->last_update_time > interval * MAX_CATCH_UP_STEPS)
+        this->last_update_time = current_time - interval * MAX_CATCH_UP_STEPS;
+    while (current_time - this->last_update_time >= interval) {
+        this->last_update_time += interval;
+        this->step(SERVO_UPDATE_INTERVAL);
     }
 }
 
-void Servo::set_angle(float angle)
-{   
-    this->angle = constrain(angle, 0.0, 180.0);
+// Trapezoidal profile: accelerate towards the goal up to the maximum velocity, and brake in time
+// to stop on it. With either limit at 0 the servo goes straight to the goal.
+void Servo::step(float dt)
+{
+    float distance = this->goal_angle - this->angle;
+    if (distance == 0.0 && this->velocity == 0.0)
+        return;
+
+    float acceleration_step = this->max_acceleration * dt;
+    if (this->max_velocity <= 0.0 || this->max_acceleration <= 0.0) {
+        this->angle = this->goal_angle;
+        this->velocity = 0.0;
+    } else if (fabs(distance) <= fabs(this->velocity) * dt + acceleration_step * dt && fabs(this->velocity) <= acceleration_step) {
+        this->angle = this->goal_angle;
+        this->velocity = 0.0;
+    } else {
+        float stopping_velocity = sqrt(2.0 * this->max_acceleration * fabs(distance));
+        float desired_velocity = copysign(min(this->max_velocity, stopping_velocity), distance);
+        this->velocity += constrain(desired_velocity - this->velocity, -acceleration_step, acceleration_step);
+        this->angle += this->velocity * dt;
+    }
+    this->write_angle();
+}
+
+// Only writes to the LEDC peripheral when the duty changes, which with 16 bits is about every
+// 0.07 degrees.
+void Servo::write_angle()
+{
     uint32_t duty_cycle = (this->angle / 180.0 * (MAX_MICROSECONDS - MIN_MICROSECONDS) + MIN_MICROSECONDS) / MAX_MICROSECONDS * 0xffff;
+    if (duty_cycle == this->duty)
+        return;
     ledcWrite(this->ledc_channel, duty_cycle);
+    this->duty = duty_cycle;
+}
+
+void Servo::set_angle(float angle)
+{   
+    this->goal_angle = constrain(angle, 0.0, 180.0);
+}
+
+void Servo::set_motion_limits(float max_velocity, float max_acceleration)
+{
+    this->max_velocity = max(max_velocity, 0.0f);
+    this->max_acceleration = max(max_acceleration, 0.0f);
 }
 
 float Servo::get_angle()
 {
     return this->angle;
 }
+
+float Servo::get_goal_angle()
+{
+    return this->goal_angle;
+}
+
+bool Servo::is_settled()
+{
+    return this->angle == this->goal_angle && this->velocity == 0.0;
+}
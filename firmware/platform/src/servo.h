@@ -30,15 +30,29 @@ public:
 
     float get_angle();
 
+    float get_goal_angle();
+
+    bool is_settled();
+
+    void set_motion_limits(float max_velocity, float max_acceleration);
+
     void set_chamber(float chamber);
 
     float get_chamber();
 
 private:
+    void step(float dt);
+
+    void write_angle();
+
     int32_t pwm_pin;
     int32_t ledc_channel;
     float goal_angle;
     float angle;
+    float velocity;
+    float max_velocity;
+    float max_acceleration;
+    uint32_t duty;
     float chamber;
     uint32_t last_update_time;
 };
\ No newline at end of file
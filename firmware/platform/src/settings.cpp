@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Preferences.h>
+#include "settings.h"
+
+static const char *SETTINGS_NAMESPACE = "gentlecare";
+static const BaseType_t SETTINGS_TASK_CORE = 0;
+static const UBaseType_t SETTINGS_TASK_PRIORITY = 1;
+static const uint32_t SETTINGS_TASK_STACK_SIZE = 3072;
+
+static Preferences preferences;
+static QueueHandle_t writes = nullptr;
+
+void Settings::begin()
+{
+    if (writes != nullptr)
+        return;
+
+    preferences.begin(SETTINGS_NAMESPACE, false);
+    writes = xQueueCreate(SETTINGS_QUEUE_LENGTH, sizeof(SettingsWrite));
+    xTaskCreatePinnedToCore(&Settings::task_entry, "settings", SETTINGS_TASK_STACK_SIZE, nullptr, SETTINGS_TASK_PRIORITY, nullptr, SETTINGS_TASK_CORE);
+}
+
+bool Settings::has(const char *key)
+{
+    return preferences.isKey(key);
+}
+
+float Settings::get_float(const char *key, float default_value)
+{
+    return preferences.getFloat(key, default_value);
+}
+
+// Writes return false if the queue is full, the caller can try again later.
+bool Settings::put_float(const char *key, float value)
+{
+    return Settings::queue_write(key, SettingsType::FLOAT, &value, sizeof(value));
+}
+
+// Only succeeds if the stored value has exactly the expected length.
+bool Settings::get_bytes(const char *key, void *data, size_t length)
+{
+    if (!preferences.isKey(key) || preferences.getBytesLength(key) != length)
+        return false;
+    return preferences.getBytes(key, data, length) == length;
+}
+
+bool Settings::put_bytes(const char *key, const void *data, size_t length)
+{
+    return Settings::queue_write(key, SettingsType::BYTES, data, length);
+}
+
+// A write with no data removes the key.
+bool Settings::remove(const char *key)
+{
+    return Settings::queue_write(key, SettingsType::BYTES, nullptr, 0);
+}
+
+bool Settings::queue_write(const char *key, SettingsType type, const void *data, size_t length)
+{
+    if (writes == nullptr || length > SETTINGS_MAX_BYTES)
+        return false;
+
+    SettingsWrite write;
+    strncpy(write.key, key, SETTINGS_KEY_LENGTH - 1);
+    write.key[SETTINGS_KEY_LENGTH - 1] = '\0';
+    write.type = type;
+    write.length = length;
+    if (length > 0)
+        memcpy(write.data, data, length);
+    return xQueueSend(writes, &write, 0) == pdTRUE;
+}
+
+void Settings::task_entry(void *parameter)
+{
+    SettingsWrite write;
+    while (true) {
+        if (xQueueReceive(writes, &write, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        if (write.length == 0) {
+            preferences.remove(write.key);
+        } else if (write.type == SettingsType::FLOAT) {
+            float value;
+            memcpy(&value, write.data, sizeof(value));
+            preferences.putFloat(write.key, value);
+        } else {
+            preferences.putBytes(write.key, write.data, write.length);
+        }
+    }
+}
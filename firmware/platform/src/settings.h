@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define SETTINGS_KEY_LENGTH 16
+#define SETTINGS_QUEUE_LENGTH 8
+#define SETTINGS_MAX_BYTES 64
+
+enum class SettingsType {
+    FLOAT,
+    BYTES,
+};
+
+struct SettingsWrite {
+    char key[SETTINGS_KEY_LENGTH];
+    SettingsType type;
+    size_t length;
+    uint8_t data[SETTINGS_MAX_BYTES];
+};
+
+// Values kept in NVS across boots. Reads go straight to flash and are meant for start(). Writes
+// are queued and done by a background task, which only keeps the Preferences calls out of the
+// control path: a flash erase still disables the cache and stalls both cores, so writes should
+// stay rare.
+class Settings {
+public:
+    static void begin();
+
+    static bool has(const char *key);
+
+    static float get_float(const char *key, float default_value);
+
+    static bool put_float(const char *key, float value);
+
+    static bool get_bytes(const char *key, void *data, size_t length);
+
+    static bool put_bytes(const char *key, const void *data, size_t length);
+
+    static bool remove(const char *key);
+
+private:
+    static bool queue_write(const char *key, SettingsType type, const void *data, size_t length);
+
+    static void task_entry(void *parameter);
+};
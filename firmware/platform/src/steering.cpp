@@ -18,52 +18,109 @@
 #include "steering.h"
 #include "config.h"
 
+// Joystick values map to states as value + 1, bit 0 of a state is the left valve and bit 1 the
+// right valve. 2 closes both valves where the platform has that state.
+static const int MIN_DIRECTION = -1;
+static const int STRAIGHT_STATE = 1;
+#if PLATFORM_TYPE == 0
+    static const uint32_t DIRECTION_LEVELS[] = {0b01, 0b11, 0b10, 0b00}; // down, straight, up, closed
+#else
+    static const uint32_t DIRECTION_LEVELS[] = {0b10, 0b00, 0b01}; // -1, 0, 1
+#endif
+static const int DIRECTION_COUNT = sizeof(DIRECTION_LEVELS) / sizeof(DIRECTION_LEVELS[0]);
+static const int VALVE_COUNT = 2;
+// Joystick values in between are rounded to a full turn beyond this in on/off mode.
+static const float ON_OFF_THRESHOLD = 0.9;
+static const uint8_t PWM_RESOLUTION_BITS = 12;
+static const uint32_t PWM_MAX_DUTY = (1 << PWM_RESOLUTION_BITS) - 1;
 
 Steering::Steering(const char *joystick_uuid, int32_t left_valve_pin, int32_t right_valve_pin)
 {
     this->left_valve_pin = left_valve_pin;
     this->right_valve_pin = right_valve_pin;
     this->direction = 0.0;
+    this->pins.add_pin(left_valve_pin);
+    this->pins.add_pin(right_valve_pin);
+    for (int i = 0; i < DIRECTION_COUNT; i++)
+        this->pins.define_state(i, DIRECTION_LEVELS[i]);
+    this->proportional = false;
+    this->ledc_channels[0] = -1;
+    this->ledc_channels[1] = -1;
+    this->pwm_frequency = 0.0;
+    this->deadband = 0.0;
+    this->duties[0] = UINT32_MAX;
+    this->duties[1] = UINT32_MAX;
     
     this->add_characteristic(joystick_uuid, std::bind(&Steering::set_direction, this, std::placeholders::_1), std::bind(&Steering::get_direction, this));
 }
 
+// Drives the valves with PWM on the given LEDC channels instead of on/off, with the duty following
+// the joystick beyond the deadband. Must be called before start().
+void Steering::set_proportional(int32_t left_ledc_channel, int32_t right_ledc_channel, float frequency, float deadband)
+{
+    this->proportional = true;
+    this->ledc_channels[0] = left_ledc_channel;
+    this->ledc_channels[1] = right_ledc_channel;
+    this->pwm_frequency = frequency;
+    this->deadband = constrain(deadband, 0.0f, 0.99f);
+}
+
 void Steering::start()
 {
-    pinMode(this->left_valve_pin, OUTPUT);
-    pinMode(this->right_valve_pin, OUTPUT);
+    if (this->proportional) {
+        int32_t pins[VALVE_COUNT] = {this->left_valve_pin, this->right_valve_pin};
+        for (int i = 0; i < VALVE_COUNT; i++) {
+            pinMode(pins[i], OUTPUT);
+            ledcSetup(this->ledc_channels[i], this->pwm_frequency, PWM_RESOLUTION_BITS);
+            ledcAttachPin(pins[i], this->ledc_channels[i]);
+            this->duties[i] = UINT32_MAX;
+        }
+    } else {
+        this->pins.start();
+    }
     this->set_direction(0.0);
 }
 
+// Values without a state leave the valves as they are.
 void Steering::set_direction(float joystick_x)
 {
     this->direction = joystick_x;
-    #if PLATFORM_TYPE == 0
-        if (joystick_x == 0.0) {
-            digitalWrite(this->left_valve_pin, HIGH);
-            digitalWrite(this->right_valve_pin, HIGH);
-        } else if (joystick_x == -1.0) { //down
-            digitalWrite(this->left_valve_pin, HIGH);
-            digitalWrite(this->right_valve_pin, LOW);
-        } else if (joystick_x == 1.0) {  //up
-            digitalWrite(this->left_valve_pin, LOW);
-            digitalWrite(this->right_valve_pin, HIGH);
-        } else if (joystick_x == 2.0) {
-            digitalWrite(this->left_valve_pin, LOW);
-            digitalWrite(this->right_valve_pin, LOW);
-        }
-    #else
-        if (joystick_x == 0.0) {
-            digitalWrite(this->left_valve_pin, LOW);
-            digitalWrite(this->right_valve_pin, LOW);
-        } else if (joystick_x == 1.0) {
-            digitalWrite(this->left_valve_pin, HIGH);
-            digitalWrite(this->right_valve_pin, LOW);
-        } else if (joystick_x == -1.0) {
-            digitalWrite(this->left_valve_pin, LOW);
-            digitalWrite(this->right_valve_pin, HIGH);
-        }
-    #endif 
+    if (this->proportional) {
+        this->set_proportional_direction(joystick_x);
+        return;
+    }
+
+    if (joystick_x != (int)joystick_x && abs(joystick_x) < 1.0)
+        joystick_x = abs(joystick_x) > ON_OFF_THRESHOLD ? copysign(1.0f, joystick_x) : 0.0f;
+    if (joystick_x == (int)joystick_x)
+        this->pins.apply((int)joystick_x - MIN_DIRECTION);
+}
+
+// Each valve's duty moves from its level when straight to its level at a full turn.
+void Steering::set_proportional_direction(float joystick_x)
+{
+    uint32_t levels = DIRECTION_LEVELS[STRAIGHT_STATE];
+    uint32_t full_levels = levels;
+    float amount = 0.0;
+    int state = (int)joystick_x - MIN_DIRECTION;
+    if (joystick_x == (int)joystick_x && state > STRAIGHT_STATE + 1) {
+        if (state >= DIRECTION_COUNT)
+            return;
+        levels = DIRECTION_LEVELS[state];
+    } else if (abs(joystick_x) > this->deadband) {
+        full_levels = DIRECTION_LEVELS[joystick_x > 0.0 ? STRAIGHT_STATE + 1 : STRAIGHT_STATE - 1];
+        amount = (min(abs(joystick_x), 1.0f) - this->deadband) / (1.0 - this->deadband);
+    }
+
+    for (int i = 0; i < VALVE_COUNT; i++) {
+        float start = (levels >> i) & 1;
+        float end = (full_levels >> i) & 1;
+        uint32_t duty = (uint32_t)((start + (end - start) * amount) * PWM_MAX_DUTY + 0.5);
+        if (duty == this->duties[i])
+            continue;
+        ledcWrite(this->ledc_channels[i], duty);
+        this->duties[i] = duty;
+    }
 }
 
 float Steering::get_direction()
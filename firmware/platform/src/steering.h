@@ -17,6 +17,7 @@
 
 #pragma once
 #include "peripheral.h"
+#include "pin_group.h"
 
 class Steering: public Peripheral {
 public:
@@ -24,12 +25,22 @@ public:
 
     void start() override;
 
+    void set_proportional(int32_t left_ledc_channel, int32_t right_ledc_channel, float frequency, float deadband);
+
     void set_direction(float joystick_x);
 
     float get_direction();
 
 private:
+    void set_proportional_direction(float joystick_x);
+
     int32_t left_valve_pin;
     int32_t right_valve_pin;
+    PinGroup pins;
+    bool proportional;
+    int32_t ledc_channels[2];
+    float pwm_frequency;
+    float deadband;
+    uint32_t duties[2];
     float direction;
 };
\ No newline at end of file
@@ -24,31 +24,29 @@ Valve::Valve(const char *valve_uuid, int32_t digital_pin1, int32_t digital_pin2)
     this->digital_pin1=digital_pin1; //3-way valve
     this->digital_pin2=digital_pin2; //2-way valve
     this->state = 0.0;
+    // Bit 0 is the 3-way valve, bit 1 the 2-way valve.
+    this->pins.add_pin(digital_pin1);
+    this->pins.add_pin(digital_pin2);
+    this->pins.define_state((int)ValveState::HOLD, 0b00);
+    this->pins.define_state((int)ValveState::DRAIN, 0b10);
+    this->pins.define_state((int)ValveState::FILL, 0b11);
 
     this->add_characteristic(valve_uuid, std::bind(&Valve::set_state, this, std::placeholders::_1), std::bind(&Valve::get_state, this));
 }
 
 void Valve::start()
 {
-    pinMode(this->digital_pin1, OUTPUT);
-    pinMode(this->digital_pin2, OUTPUT);
+    this->pins.start();
     this->set_state(0.0);
     this->last_update_time = micros();
 }
 
+// Values that aren't a ValveState leave the valves as they are.
 void Valve::set_state(float state)
 {
     this->state = state;
-    if (state == (float)ValveState::HOLD) { //hold
-        digitalWrite(this->digital_pin1, LOW);
-        digitalWrite(this->digital_pin2, LOW);
-    } else if (state == (float)ValveState::DRAIN) { //drain
-        digitalWrite(this->digital_pin1, LOW);
-        digitalWrite(this->digital_pin2, HIGH);
-    } else if (state == (float)ValveState::FILL) { //fill
-        digitalWrite(this->digital_pin1, HIGH);
-        digitalWrite(this->digital_pin2, HIGH);
-    }
+    if (state == (int)state)
+        this->pins.apply((int)state);
 }
 
 float Valve::get_state()
@@ -17,6 +17,7 @@
 
 #pragma once
 #include "peripheral.h"
+#include "pin_group.h"
 
 enum class ValveState{
     HOLD,
@@ -41,6 +42,7 @@ public:
 private:
     int32_t digital_pin1;
     int32_t digital_pin2;
+    PinGroup pins;
     float state;
     uint32_t last_update_time;
 };
\ No newline at end of file
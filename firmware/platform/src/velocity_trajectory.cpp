@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "velocity_trajectory.h"
+
+VelocityTrajectory::VelocityTrajectory()
+{
+    this->set_limits(0.0, 0.0);
+    this->set_stop_limits(0.0, 0.0);
+    this->reset(0.0);
+}
+
+void VelocityTrajectory::set_limits(float max_acceleration, float max_jerk)
+{
+    this->max_acceleration = max_acceleration;
+    this->max_jerk = max_jerk;
+}
+
+void VelocityTrajectory::set_stop_limits(float max_acceleration, float max_jerk)
+{
+    this->stop_acceleration = max_acceleration;
+    this->stop_jerk = max_jerk;
+}
+
+void VelocityTrajectory::set_target(float target)
+{
+    this->target = target;
+}
+
+void VelocityTrajectory::reset(float velocity)
+{
+    this->target = velocity;
+    this->velocity = velocity;
+    this->acceleration = 0.0;
+}
+
+float VelocityTrajectory::update(float dt)
+{
+    float max_acceleration = this->max_acceleration;
+    float max_jerk = this->max_jerk;
+    if (this->target == 0.0 && this->stop_acceleration > 0.0 && this->stop_jerk > 0.0) {
+        max_acceleration = this->stop_acceleration;
+        max_jerk = this->stop_jerk;
+    }
+
+    if (max_acceleration <= 0.0 || max_jerk <= 0.0)
+        this->reset(this->target);
+    if (this->is_settled())
+        return this->velocity;
+
+    float error = this->target - this->velocity;
+    float jerk_step = max_jerk * dt;
+    if (fabs(error) <= jerk_step * dt && fabs(this->acceleration) <= jerk_step) {
+        this->reset(this->target);
+        return this->velocity;
+    }
+
+    // Velocity still gained while bringing the acceleration back to zero at the jerk limit. Once
+    // that covers the remaining error it is time to start easing off.
+    float easing = this->acceleration * fabs(this->acceleration) / (2.0 * max_jerk);
+    float desired_acceleration = error - easing > 0.0 ? max_acceleration : -max_acceleration;
+    this->acceleration += constrain(desired_acceleration - this->acceleration, -jerk_step, jerk_step);
+    this->velocity += this->acceleration * dt;
+
+    if ((this->target - this->velocity) * error <= 0.0)
+        this->reset(this->target);
+    return this->velocity;
+}
+
+float VelocityTrajectory::get_velocity()
+{
+    return this->velocity;
+}
+
+bool VelocityTrajectory::is_settled()
+{
+    return this->velocity == this->target && this->acceleration == 0.0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 GentleCare Corporation. All rights reserved.
+ *
+ * This source code and the accompanying materials are the confidential and
+ * proprietary information of GentleCare Corporation. Unauthorized copying or
+ * distribution of this file, via any medium, is strictly prohibited without
+ * the prior written permission of GentleCare Corporation.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+// Jerk and acceleration limited velocity profile (S-curve). Setting a new target does not change
+// the output immediately, update() moves it towards the target within the limits. Without limits
+// (the default) the output follows the target directly. Stops (a target of zero) may use their own,
+// higher limits so the motor comes to rest sooner without stepping.
+class VelocityTrajectory {
+public:
+    VelocityTrajectory();
+
+    void set_limits(float max_acceleration, float max_jerk);
+
+    void set_stop_limits(float max_acceleration, float max_jerk);
+
+    void set_target(float target);
+
+    void reset(float velocity);
+
+    float update(float dt);
+
+    float get_velocity();
+
+    bool is_settled();
+
+private:
+    float max_acceleration;
+    float max_jerk;
+    float stop_acceleration;
+    float stop_jerk;
+    float target;
+    float velocity;
+    float acceleration;
+};
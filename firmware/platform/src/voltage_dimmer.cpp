@@ -18,21 +18,60 @@
 #include <Arduino.h>
 #include "voltage_dimmer.h"
 #include "config.h"
+#include "dimmer_curve.h"
+#include "settings.h"
+
+// The sweep holds each duty long enough for the pressure to settle, then averages it. Pressure
+// rises linearly with pump voltage above a cut-in of about 10 V (EXPERIMENTATION.md, experiment
+// 2), which is how the pressures are turned back into voltages.
+static const float SWEEP_SETTLE_TIME = 4.0;
+static const float SWEEP_MEASURE_TIME = 3.0;
+static const float SWEEP_MIN_PRESSURE = 0.1;
+static const float SWEEP_PRESSURE_THRESHOLD = 0.02;
+static const float PUMP_CUT_IN_VOLTAGE = 10.0;
+static const float MIN_VOLTAGE_STEP = 0.1;
 
 VoltageDimmer::VoltageDimmer()
 {
     this->pwm_pin = -1;
     this->ledc_channel = 5.0;
     this->voltage = 0.0;
+    this->target_voltage = 0.0;
+    this->slew_rate_up = 0.0;
+    this->slew_rate_down = 0.0;
+    this->duty = UINT32_MAX;
+    this->calibration_key = nullptr;
+    this->pressure_sensor = nullptr;
+    this->calibrated = false;
+    this->calibration_state = DimmerCalibrationState::DEFAULT_CURVE;
+    this->sweep_allowed = true;
+    this->sweep_step = 0;
+    this->sweep_time = 0.0;
+    this->sweep_sum = 0.0;
+    this->sweep_count = 0;
 }
 
-VoltageDimmer::VoltageDimmer(const char *uuid, int32_t pwm_pin, int32_t ledc_channel)
+VoltageDimmer::VoltageDimmer(const char *uuid, const char *calibration_uuid, const char *calibration_key, PressureSensor *pressure_sensor, int32_t pwm_pin, int32_t ledc_channel)
 {
     this->pwm_pin = pwm_pin;
     this->ledc_channel = ledc_channel;
     this->voltage = 0.0;
+    this->target_voltage = 0.0;
+    this->slew_rate_up = 0.0;
+    this->slew_rate_down = 0.0;
+    this->duty = UINT32_MAX;
+    this->calibration_key = calibration_key;
+    this->pressure_sensor = pressure_sensor;
+    this->calibrated = false;
+    this->calibration_state = DimmerCalibrationState::DEFAULT_CURVE;
+    this->sweep_allowed = true;
+    this->sweep_step = 0;
+    this->sweep_time = 0.0;
+    this->sweep_sum = 0.0;
+    this->sweep_count = 0;
 
     this->add_characteristic(uuid, std::bind(&VoltageDimmer::set_voltage, this, std::placeholders::_1), std::bind(&VoltageDimmer::get_voltage, this));
+    this->add_characteristic(calibration_uuid, std::bind(&VoltageDimmer::set_calibration_command, this, std::placeholders::_1), std::bind(&VoltageDimmer::get_calibration_state, this));
 }
 
 void VoltageDimmer::start()
@@ -40,46 +79,245 @@ void VoltageDimmer::start()
     pinMode(this->pwm_pin, OUTPUT);
     ledcSetup(this->ledc_channel, 1000, 16);
     ledcAttachPin(this->pwm_pin, this->ledc_channel);
-    this->set_voltage(this->voltage);
+
+    Settings::begin();
+    if (this->calibration_key != nullptr && Settings::get_bytes(this->calibration_key, &this->calibration, sizeof(this->calibration))) {
+        this->calibrated = true;
+        this->calibration_state = DimmerCalibrationState::CALIBRATED;
+    }
+    this->duty = UINT32_MAX;
+    this->write_voltage();
+}
+
+void VoltageDimmer::update(float dt)
+{
+    Peripheral::update(dt);
+    if (this->calibration_state == DimmerCalibrationState::SWEEPING)
+        this->update_sweep(dt);
+    else
+        this->ramp(dt);
 }
+
+// The output follows the requested voltage at the slew rates, or at once if a rate is 0. Switching
+// off (0 V) is always immediate, controllers use it to stop on over-pressure or stale readings.
+// While a sweep runs the requested voltage is only remembered, and ramped to once the sweep ends.
 void VoltageDimmer::set_voltage(float voltage)
 {
     if (ledc_channel == NAN)
         return;
 
-    this->voltage = constrain(voltage, 0.0, 120.0);
-    float percentage = this->voltage_to_pwm_percentage(this->voltage);
-    ledcWrite(this->ledc_channel, (uint32_t)(percentage * 0xffff));
+    this->target_voltage = constrain(voltage, 0.0, MAX_DIMMER_VOLTAGE);
+    if (this->calibration_state != DimmerCalibrationState::SWEEPING)
+        this->ramp(0.0);
+}
+
+float VoltageDimmer::get_target_voltage()
+{
+    return this->target_voltage;
+}
+
+// Rates are in volts per second, 0 disables the limit in that direction.
+void VoltageDimmer::set_slew_rates(float up, float down)
+{
+    this->slew_rate_up = max(0.0f, up);
+    this->slew_rate_down = max(0.0f, down);
+}
+
+void VoltageDimmer::ramp(float dt)
+{
+    float rate = this->target_voltage > this->voltage ? this->slew_rate_up : this->slew_rate_down;
+    if (rate <= 0.0 || this->target_voltage == 0.0)
+        this->voltage = this->target_voltage;
+    else
+        this->voltage += constrain(this->target_voltage - this->voltage, -rate * dt, rate * dt);
+    this->write_voltage();
+}
+
+void VoltageDimmer::write_voltage()
+{
+    this->write_percentage(this->voltage_to_pwm_percentage(this->voltage));
 }
 
 float VoltageDimmer::get_voltage()
 {
+    if (this->calibration_state == DimmerCalibrationState::SWEEPING)
+        return this->pwm_percentage_to_voltage((float)this->sweep_step / (DIMMER_CALIBRATION_POINTS - 1));
     return this->voltage;
 }
 
 void VoltageDimmer::mode_changed(ServiceMode mode)
 {
-    this->set_voltage(0.0);
+    this->abort_sweep();
+}
+
+// Switching off is not ramped.
+void VoltageDimmer::abort_sweep()
+{
+    if (this->calibration_state == DimmerCalibrationState::SWEEPING)
+        this->calibration_state = DimmerCalibrationState::FAILED;
+    this->target_voltage = 0.0;
+    this->voltage = 0.0;
+    this->write_voltage();
 }
 
-static const float A = 1.3;
-static const float P = 1.9;
-static const float Q = 0.6;
+void VoltageDimmer::set_calibration_command(float command)
+{
+    if (command > 0.0 && this->calibration_state != DimmerCalibrationState::SWEEPING) {
+        this->start_sweep();
+    } else if (command == 0.0 && this->calibration_state == DimmerCalibrationState::SWEEPING) {
+        this->stop_sweep(DimmerCalibrationState::FAILED);
+    } else if (command < 0.0 && this->calibration_state != DimmerCalibrationState::SWEEPING) {
+        if (this->calibration_key != nullptr)
+            Settings::remove(this->calibration_key);
+        this->calibrated = false;
+        this->calibration_state = DimmerCalibrationState::DEFAULT_CURVE;
+        this->write_voltage();
+    }
+}
+
+// Controllers only allow sweeps while they are idle, and leaving idle aborts a running one.
+void VoltageDimmer::set_sweep_allowed(bool allowed)
+{
+    this->sweep_allowed = allowed;
+    if (!allowed && this->calibration_state == DimmerCalibrationState::SWEEPING) {
+        Serial.println("Dimmer calibration aborted, the platform left idle");
+        this->abort_sweep();
+    }
+}
+
+float VoltageDimmer::get_calibration_state()
+{
+    return (float)this->calibration_state;
+}
+
+// Only writes to the LEDC peripheral when the duty changes.
+void VoltageDimmer::write_percentage(float percentage)
+{
+    uint32_t duty = (uint32_t)(constrain(percentage, 0.0f, 1.0f) * 0xffff);
+    if (duty == this->duty)
+        return;
+    ledcWrite(this->ledc_channel, duty);
+    this->duty = duty;
+}
+
+void VoltageDimmer::start_sweep()
+{
+    if (!this->sweep_allowed || this->target_voltage != 0.0) {
+        Serial.println("Dimmer calibration needs the platform to be idle");
+        this->calibration_state = DimmerCalibrationState::FAILED;
+        return;
+    }
+    if (this->pressure_sensor == nullptr || !this->pressure_sensor->is_ok()) {
+        Serial.println("Dimmer calibration needs a working pressure sensor");
+        this->calibration_state = DimmerCalibrationState::FAILED;
+        return;
+    }
+
+    Serial.println("Dimmer calibration: keep the sheet still until the sweep ends");
+    this->calibration_state = DimmerCalibrationState::SWEEPING;
+    this->sweep_pressures[0] = 0.0;
+    this->sweep_step = 1;
+    this->sweep_time = 0.0;
+    this->sweep_sum = 0.0;
+    this->sweep_count = 0;
+    this->write_percentage((float)this->sweep_step / (DIMMER_CALIBRATION_POINTS - 1));
+}
+
+// The output ramps from the last step's voltage to the requested one.
+void VoltageDimmer::stop_sweep(DimmerCalibrationState state)
+{
+    this->voltage = this->get_voltage();
+    this->calibration_state = state;
+    this->ramp(0.0);
+}
+
+void VoltageDimmer::update_sweep(float dt)
+{
+    if (this->pressure_sensor->get_pressure() > PRESSURE_LIMIT) {
+        Serial.println("Dimmer calibration aborted, pressure limit reached");
+        this->abort_sweep();
+        return;
+    }
+
+    this->sweep_time += dt;
+    if (this->sweep_time < SWEEP_SETTLE_TIME)
+        return;
+
+    this->sweep_sum += this->pressure_sensor->get_pressure();
+    this->sweep_count++;
+    if (this->sweep_time < SWEEP_SETTLE_TIME + SWEEP_MEASURE_TIME)
+        return;
+
+    float percentage = (float)this->sweep_step / (DIMMER_CALIBRATION_POINTS - 1);
+    this->sweep_pressures[this->sweep_step] = this->sweep_sum / this->sweep_count;
+    Serial.print("Dimmer calibration: duty ");
+    Serial.print(percentage);
+    Serial.print(" pressure ");
+    Serial.println(this->sweep_pressures[this->sweep_step]);
+
+    if (++this->sweep_step == DIMMER_CALIBRATION_POINTS) {
+        this->stop_sweep(this->finish_sweep() ? DimmerCalibrationState::CALIBRATED : DimmerCalibrationState::FAILED);
+        return;
+    }
+    this->sweep_time = 0.0;
+    this->sweep_sum = 0.0;
+    this->sweep_count = 0;
+    this->write_percentage((float)this->sweep_step / (DIMMER_CALIBRATION_POINTS - 1));
+}
+
+// A failed sweep keeps the previous calibration, if there was one. Full duty is taken as the
+// maximum voltage and the other duties are scaled by their pressure. Duties below the pump's
+// cut-in keep the default curve, capped at the cut-in voltage. The table is made strictly
+// increasing so it can be inverted.
+bool VoltageDimmer::finish_sweep()
+{
+    float max_pressure = this->sweep_pressures[DIMMER_CALIBRATION_POINTS - 1];
+    if (max_pressure < SWEEP_MIN_PRESSURE) {
+        Serial.println("Dimmer calibration failed, no pressure at full duty");
+        return false;
+    }
+
+    DimmerCalibration calibration;
+    calibration.voltages[0] = 0.0;
+    for (int i = 1; i < DIMMER_CALIBRATION_POINTS; i++) {
+        float percentage = (float)i / (DIMMER_CALIBRATION_POINTS - 1);
+        float voltage = min(dimmer_curve_voltage(percentage), PUMP_CUT_IN_VOLTAGE);
+        if (this->sweep_pressures[i] > SWEEP_PRESSURE_THRESHOLD)
+            voltage = PUMP_CUT_IN_VOLTAGE + (MAX_DIMMER_VOLTAGE - PUMP_CUT_IN_VOLTAGE) * min(this->sweep_pressures[i] / max_pressure, 1.0f);
+        calibration.voltages[i] = max(voltage, calibration.voltages[i - 1] + MIN_VOLTAGE_STEP);
+    }
+    calibration.voltages[DIMMER_CALIBRATION_POINTS - 1] = MAX_DIMMER_VOLTAGE;
+    for (int i = DIMMER_CALIBRATION_POINTS - 2; i > 0; i--)
+        calibration.voltages[i] = min(calibration.voltages[i], calibration.voltages[i + 1] - MIN_VOLTAGE_STEP);
+
+    this->calibration = calibration;
+    this->calibrated = true;
+    if (this->calibration_key != nullptr)
+        Settings::put_bytes(this->calibration_key, &this->calibration, sizeof(this->calibration));
+    return true;
+}
 
 float VoltageDimmer::pwm_percentage_to_voltage(float percentage)
 {
-    percentage = constrain(percentage, 0.0, 1.0);
-    if (percentage == 1.0)
-        return MAX_DIMMER_VOLTAGE;
-    
-    return MAX_DIMMER_VOLTAGE * pow(1.0 + A * pow(percentage / (1.0 - percentage), -P), -Q);
+    if (!this->calibrated)
+        return dimmer_curve_voltage(percentage);
+
+    float position = constrain(percentage, 0.0f, 1.0f) * (DIMMER_CALIBRATION_POINTS - 1);
+    int index = min((int)position, DIMMER_CALIBRATION_POINTS - 2);
+    float weight = position - index;
+    return this->calibration.voltages[index] + (this->calibration.voltages[index + 1] - this->calibration.voltages[index]) * weight;
 }
 
 float VoltageDimmer::voltage_to_pwm_percentage(float voltage)
 {
-    voltage = constrain(voltage, 0.0, MAX_DIMMER_VOLTAGE);
-    if (voltage == 0.0)
-        return 0.0;
+    if (!this->calibrated)
+        return dimmer_curve_percentage(voltage);
 
-    return 1.0 / (1.0 + pow((pow(voltage / 120.0, -1.0 / Q) - 1.0) / A, 1.0 / P));
-}
\ No newline at end of file
+    voltage = constrain(voltage, 0.0f, (float)MAX_DIMMER_VOLTAGE);
+    int index = 0;
+    while (index < DIMMER_CALIBRATION_POINTS - 2 && voltage > this->calibration.voltages[index + 1])
+        index++;
+    float low = this->calibration.voltages[index];
+    float high = this->calibration.voltages[index + 1];
+    return (index + (voltage - low) / (high - low)) / (DIMMER_CALIBRATION_POINTS - 1);
+}
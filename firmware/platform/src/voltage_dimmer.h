@@ -17,27 +17,86 @@
 
 #pragma once
 #include "peripheral.h"
+#include "pressure_sensor.h"
+
+#define DIMMER_CALIBRATION_POINTS 11
+
+// Voltage at evenly spaced duties from 0 to 1, as stored in NVS.
+struct DimmerCalibration {
+    float voltages[DIMMER_CALIBRATION_POINTS];
+};
+
+enum class DimmerCalibrationState {
+    DEFAULT_CURVE,
+    SWEEPING,
+    CALIBRATED,
+    FAILED,
+};
 
 class VoltageDimmer: public Peripheral {
 public:
     VoltageDimmer(); 
     
-    VoltageDimmer(const char *uuid, int32_t pwm_pin, int32_t ledc_channel);
+    VoltageDimmer(const char *uuid, const char *calibration_uuid, const char *calibration_key, PressureSensor *pressure_sensor, int32_t pwm_pin, int32_t ledc_channel);
 
     void start() override;
 
+    void update(float dt) override;
+
     void mode_changed(ServiceMode mode) override;
 
     void set_voltage(float voltage);
 
     float get_voltage();
 
+    float get_target_voltage();
+
+    void set_slew_rates(float up, float down);
+
+    // 1 starts a sweep, 0 aborts it and -1 goes back to the default curve.
+    void set_calibration_command(float command);
+
+    void set_sweep_allowed(bool allowed);
+
+    float get_calibration_state();
+
 private:
     float pwm_percentage_to_voltage(float percentage);
 
     float voltage_to_pwm_percentage(float voltage);
 
+    void ramp(float dt);
+
+    void write_voltage();
+
+    void write_percentage(float percentage);
+
+    void start_sweep();
+
+    void stop_sweep(DimmerCalibrationState state);
+
+    void abort_sweep();
+
+    void update_sweep(float dt);
+
+    bool finish_sweep();
+
     int32_t pwm_pin;
     int32_t ledc_channel;
     float voltage;
+    float target_voltage;
+    float slew_rate_up;
+    float slew_rate_down;
+    uint32_t duty;
+    const char *calibration_key;
+    PressureSensor *pressure_sensor;
+    DimmerCalibration calibration;
+    bool calibrated;
+    DimmerCalibrationState calibration_state;
+    bool sweep_allowed;
+    float sweep_pressures[DIMMER_CALIBRATION_POINTS];
+    int sweep_step;
+    float sweep_time;
+    float sweep_sum;
+    int sweep_count;
 };
\ No newline at end of file
@@ -18,24 +18,33 @@
 #include <math.h>
 #include "wedges_controller.h"
 #include "service.h"
+#include "scheduler.h"
 #include "config.h"
 
 static const float DEFAULT_HOLD_TIME = 1.0 * 60.0 * 1000.0;
+// Time the rail valves take to switch before eversion drives the motor, and the pause between
+// releasing the rail and reversing it after inversion.
+static const float RAIL_SWITCH_TIME = 0.2;
+static const float RAIL_RELEASE_TIME = 0.05;
 
 WedgesController::WedgesController(const char *mode_uuid, const char *progress_uuid, const char *timer_uuid, 
-    VoltageDimmer *dimmer, MotorController *motor, PressureSensor *pressure_sensor1, PressureSensor *pressure_sensor2, Servo *servo, Valve *valve, Steering *rail)
+    VoltageDimmer *dimmer, MotorController *motor, PressureSensor *pressure_sensor1, PressureSensor *pressure_sensor2, PressureSampler *pressure_sampler, Servo *servo, Valve *valve, Steering *rail)
 {
     this->dimmer = dimmer;
     this->motor = motor;
     this->valve = valve;
     this->pressure_sensor1 = pressure_sensor1;
     this->pressure_sensor2 = pressure_sensor2;
+    this->pressure_sampler = pressure_sampler;
     this->servo = servo;
     this->rail = rail;
-    this->rail_pin = RAIL_STATE_PIN;
+    this->rail_input = InputPin(RAIL_STATE_PIN, INPUT, RAIL_STATE_DEBOUNCE_TIME);
     this->to_rail_pin = BOX_TO_RAIL_PIN;
-    pinMode(this->rail_pin, INPUT);
-    pinMode(this->to_rail_pin, OUTPUT);
+    this->to_rail_output.add_pin(this->to_rail_pin);
+    this->to_rail_output.define_state(LOW, LOW);
+    this->to_rail_output.define_state(HIGH, HIGH);
+    this->to_rail_output.start();
+    this->rail_switching = false;
     this->set_mode((float)AutoControlMode::IDLE);
     this->timer_active = false;
 
@@ -44,20 +53,32 @@ WedgesController::WedgesController(const char *mode_uuid, const char *progress_u
     this->add_characteristic(timer_uuid, nullptr, std::bind(&WedgesController::get_time, this)); 
 }
 
+void WedgesController::start()
+{
+    this->rail_input.start();
+}
+
 void WedgesController::update(float dt)
 {
     Peripheral::update(dt);
+
+    InputEvent rail_event;
+    while (this->rail_input.read_event(&rail_event)) {
+#if DEBUG_MODE
+        Serial.printf("Rail %s at %u us\n", rail_event.level ? "engaged" : "released", rail_event.time);
+#endif
+    }
     
     float progress = this->get_progress();
     float max_speed = constrain(progress / 0.3, 0.0, 1.0) * 10.0 + 5.0;
     if (this->mode == AutoControlMode::IDLE && progress <= 0.02) {
-        digitalWrite(this->to_rail_pin, LOW);
+        this->to_rail_output.apply(LOW);
     } else {
-        digitalWrite(this->to_rail_pin, HIGH);
+        this->to_rail_output.apply(HIGH);
     }
 
-    if (this->mode == AutoControlMode::EVERSION) {
-        if (digitalRead(this->rail_pin)==HIGH){
+    if (this->mode == AutoControlMode::EVERSION && !this->rail_switching) {
+        if (this->rail_input.get_level() == HIGH) {
             this->auto_eversion(progress);
         } else if (this->rail->get_direction() != 1.0) {
             this->rail->set_direction(1.0);
@@ -68,12 +89,18 @@ void WedgesController::update(float dt)
         
     } else if (this->mode == AutoControlMode::TRANSFER){
         this->valve->set_state((float)ValveState::FILL);
+        PressurePair pressures = this->pressure_sampler->get_pair();
+        // Without fresh pressures the fill can't be steered or stopped, so the pump waits.
+        if (!this->pressure_sampler->is_recent(pressures)) {
+            this->dimmer->set_voltage(0.0);
+            return;
+        }
         this->dimmer->set_voltage(60.0);
-        float pressure_sum = pressure_sensor1->get_pressure() + pressure_sensor2->get_pressure();
+        float pressure_sum = pressures.pressure1 + pressures.pressure2;
         float pressure_error = 0.9 - pressure_sum;
-        this->servo->set_angle(this->servo->get_angle() + 10.0 * pressure_error * dt);
+        this->servo->set_angle(this->servo->get_goal_angle() + 10.0 * pressure_error * dt);
 
-        if (pressure_sensor2->get_pressure() >= 1.08){
+        if (pressures.pressure2 >= 1.08){
             this->set_mode((float)AutoControlMode::TRANSFER_PAUSED);
             this->timer_start = millis();
             this->timer_active = true;
@@ -99,6 +126,9 @@ void WedgesController::set_mode(float mode)
         return;
 
     this->mode = (AutoControlMode)mode;
+    this->dimmer->set_sweep_allowed(this->mode == AutoControlMode::IDLE);
+    Scheduler::cancel(this);
+    this->rail_switching = false;
     if (this->mode == AutoControlMode::IDLE) {
         this->dimmer->set_voltage(0);
         this->valve->set_state((float)ValveState::HOLD);
@@ -107,7 +137,8 @@ void WedgesController::set_mode(float mode)
         //this->dimmer->set_voltage(BASE_VOLTAGE);
         this->valve->set_state((float)ValveState::HOLD);
         this->rail->set_direction(1.0);
-        delay(200);
+        this->rail_switching = true;
+        Scheduler::schedule(RAIL_SWITCH_TIME, [this]() { this->rail_switching = false; }, this);
 
     } else if (this->mode == AutoControlMode::EVERSION_PAUSED) {
         this->dimmer->set_voltage(EVERSION_PAUSED_VOLTAGE);
@@ -176,10 +207,8 @@ void WedgesController::auto_inversion(float progress)
     float inversion_voltage = (1.0 - progress) * 32.0 + 20.0;
     if (progress <= 0.0){
         this->set_mode((float)AutoControlMode::IDLE);
-        digitalWrite(this->to_rail_pin, LOW);
-        delay(50);
-        this->rail->set_direction(-1.0);
-        delay(150);
+        this->to_rail_output.apply(LOW);
+        Scheduler::schedule(RAIL_RELEASE_TIME, [this]() { this->rail->set_direction(-1.0); }, this);
     } else if (progress <= 0.02){
         this->dimmer->set_voltage(0.0);
         this->motor->set_velocity(-0.2);
@@ -21,16 +21,20 @@
 #include "voltage_dimmer.h"
 #include "motor_controller.h"
 #include "pressure_sensor.h"
+#include "pressure_sampler.h"
 #include "servo.h"
 #include "tension_controller.h"
 #include "valve.h"
 #include "auto_controller.h"
 #include "steering.h"
+#include "input_pin.h"
 
 
 class WedgesController: public Peripheral {
 public:
-    WedgesController(const char *mode_uuid, const char *progress_uuid, const char *timer_uuid, VoltageDimmer *dimmer, MotorController *motor, PressureSensor *pressure_sensor1, PressureSensor *pressure_sensor2, Servo *servo, Valve *valve, Steering *rail);
+    WedgesController(const char *mode_uuid, const char *progress_uuid, const char *timer_uuid, VoltageDimmer *dimmer, MotorController *motor, PressureSensor *pressure_sensor1, PressureSensor *pressure_sensor2, PressureSampler *pressure_sampler, Servo *servo, Valve *valve, Steering *rail);
+
+    void start() override;
 
     void update(float dt) override;
 
@@ -56,12 +60,15 @@ private:
     Valve *valve;
     PressureSensor *pressure_sensor1;
     PressureSensor *pressure_sensor2;
+    PressureSampler *pressure_sampler;
     Servo *servo;
     Steering *rail;
     AutoControlMode mode;
     TensionController tension_controller;
-    int32_t rail_pin;
+    InputPin rail_input;
     int32_t to_rail_pin;
+    PinGroup to_rail_output;
+    bool rail_switching;
     bool timer_active;
     unsigned long timer_start;
 };
\ No newline at end of file
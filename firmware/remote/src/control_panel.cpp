@@ -18,6 +18,12 @@
 #include "control_panel.h"
 #include "config.h"
 
+// The joystick is sent as a continuous value, rounded to steps so that ADC noise doesn't cause a
+// write every loop. The platform applies its own deadband on top. Writes are at least
+// JOYSTICK_INTERVAL_MS apart.
+static const float JOYSTICK_DEADBAND = 0.1;
+static const float JOYSTICK_STEP = 0.05;
+static const uint32_t JOYSTICK_INTERVAL_MS = 25;
 
 ControlPanel::ControlPanel(RemotePlatform *platform, Adafruit_SSD1306 *display, PowerManagement *power)
 {
@@ -26,6 +32,8 @@ ControlPanel::ControlPanel(RemotePlatform *platform, Adafruit_SSD1306 *display,
     this->power = power;
     this->velocity_setpoint = 0.0;
     this->state_before_stop = 0.0;
+    this->joystick_value = 0.0;
+    this->joystick_time = 0;
 }
 
 void ControlPanel::start(int32_t button_pins[(int)ButtonType::COUNT], uint32_t knob_dt_pins[(int)KnobType::COUNT], 
@@ -63,7 +71,8 @@ void ControlPanel::update_buttons()
                 this->platform->set(AUTO_CONTROL_MODE_UUID, 0.0);
                 this->platform->set(PRESSURE_CONTROLLER_UUID, 0.0);
                 this->platform->set(JOYSTICK_UUID, 2.0);
-                delay(25);
+                this->joystick_value = 2.0;
+                this->joystick_time = millis();
             } else if (i == (int)ButtonType::PAUSE) {
                 float mode = this->platform->get(AUTO_CONTROL_MODE_UUID);
                 if (mode == 1.0)
@@ -142,17 +151,25 @@ void ControlPanel::update_knobs()
     }
 }
 
+// Centring the joystick doesn't undo the stop button closing the valves (2).
 void ControlPanel::update_joystick()
 {
-    float x_value = (analogRead(JOYSTICK_VRX_PIN)/2048.0) - 1.0;
-    if (x_value > 0.9) {
-        this->platform->set(JOYSTICK_UUID, 1.0);
-        delay(25);
-    } else if (x_value < -0.9) {
-        this->platform->set(JOYSTICK_UUID, -1.0);
-        delay(25);
-    } else if (this->platform->get(JOYSTICK_UUID) != 2.0)
-        this->platform->set(JOYSTICK_UUID, 0.0);
+    float raw_value = (analogRead(JOYSTICK_VRX_PIN)/2048.0) - 1.0;
+    bool stopped = this->joystick_value == 2.0 || this->platform->get(JOYSTICK_UUID) == 2.0;
+    // The stick has to move a whole step away from the value last sent, half a step past the
+    // rounding boundary, so ADC noise at a boundary doesn't toggle between two steps.
+    if (!stopped && abs(raw_value - this->joystick_value) < JOYSTICK_STEP)
+        return;
+
+    float x_value = abs(raw_value) < JOYSTICK_DEADBAND ? 0.0 : constrain(round(raw_value / JOYSTICK_STEP) * JOYSTICK_STEP, -1.0, 1.0);
+    if (x_value == this->joystick_value || (x_value == 0.0 && stopped))
+        return;
+    if (millis() - this->joystick_time < JOYSTICK_INTERVAL_MS)
+        return;
+
+    this->platform->set(JOYSTICK_UUID, x_value);
+    this->joystick_value = x_value;
+    this->joystick_time = millis();
 }
 
 void ControlPanel::update_display()
@@ -214,6 +231,8 @@ void ControlPanel::update_display()
         //         //TODO: replace with jam detected
         //         this->display->printf("PRESSURE ERROR: %i\n", (int)this->platform->get(PRESSURE_SENSOR_ERROR_UUID));
     }
+    if (this->platform->get(MOTOR_ERROR_UUID) == 0.0 && this->platform->get(MOTOR_CALIBRATION_UUID) != 0.0)
+        this->display->printf("MOTOR CALIBRATING\n");
     
     #if DEVELOPER_SCREEN
         #if PLATFORM_TYPE == 0
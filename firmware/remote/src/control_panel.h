@@ -83,6 +83,8 @@ private:
     float velocity_setpoint;
     bool transferring;
     float state_before_stop;
+    float joystick_value;
+    uint32_t joystick_time;
     int32_t button_pins[(int)ButtonType::COUNT];
     bool button_pressed[(int)ButtonType::COUNT];
     ESP32Encoder knobs[(int)KnobType::COUNT];
@@ -0,0 +1,88 @@
+// Compares the dimmer curve lookup tables in dimmer_curve.h with the analytic curve they replace:
+// nanoseconds per conversion for each, and the largest difference between them over a dense sweep.
+//
+// Build from firmware/:
+//   g++ -std=gnu++17 -O2 -I tools/host -I platform/src -D PLATFORM_TYPE=0
+//       tools/dimmer_curve_benchmark.cpp tools/host/arduino.cpp -pthread -o dimmer_curve_benchmark
+//
+// Usage: ./dimmer_curve_benchmark [calls]
+//
+// The ESP32 has a single-precision FPU only, so the double pow() calls of the analytic curve cost
+// far more there than on a desktop, while the table lookups cost about the same on both.
+
+#include <Arduino.h>
+#include <chrono>
+#include "dimmer_curve.h"
+
+static const int SWEEP_POINTS = 1000000;
+
+// The previous VoltageDimmer conversions.
+static float analytic_pwm_percentage_to_voltage(float percentage)
+{
+    percentage = constrain(percentage, 0.0, 1.0);
+    if (percentage == 1.0)
+        return MAX_DIMMER_VOLTAGE;
+
+    return MAX_DIMMER_VOLTAGE * pow(1.0 + DIMMER_CURVE_A * pow(percentage / (1.0 - percentage), -DIMMER_CURVE_P), -DIMMER_CURVE_Q);
+}
+
+static float analytic_voltage_to_pwm_percentage(float voltage)
+{
+    voltage = constrain(voltage, 0.0, MAX_DIMMER_VOLTAGE);
+    if (voltage == 0.0)
+        return 0.0;
+
+    return 1.0 / (1.0 + pow((pow(voltage / 120.0, -1.0 / DIMMER_CURVE_Q) - 1.0) / DIMMER_CURVE_A, 1.0 / DIMMER_CURVE_P));
+}
+
+static float table_pwm_percentage_to_voltage(float percentage)
+{
+    return dimmer_curve_voltage(percentage);
+}
+
+static float table_voltage_to_pwm_percentage(float voltage)
+{
+    return dimmer_curve_percentage(voltage);
+}
+
+static double time_per_call(float (*function)(float), float scale, int calls)
+{
+    volatile float sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++)
+        sink = sink + function(scale * (i % 1000) / 1000.0f);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+static float max_error(float (*table)(float), float (*analytic)(float), float scale, float *worst_input)
+{
+    float worst = 0.0;
+    for (int i = 0; i <= SWEEP_POINTS; i++) {
+        float input = scale * i / SWEEP_POINTS;
+        float error = abs(table(input) - analytic(input));
+        if (error > worst) {
+            worst = error;
+            *worst_input = input;
+        }
+    }
+    return worst;
+}
+
+int main(int argc, char **argv)
+{
+    int calls = argc > 1 ? atoi(argv[1]) : 10000000;
+    printf("%d entries per table, %d calls per measurement\n\n", DIMMER_CURVE_SIZE, calls);
+    printf("  %-26s %10s %10s\n", "conversion", "analytic", "table");
+    printf("  %-26s %7.1f ns %7.1f ns\n", "duty to voltage",
+           time_per_call(analytic_pwm_percentage_to_voltage, 1.0, calls), time_per_call(table_pwm_percentage_to_voltage, 1.0, calls));
+    printf("  %-26s %7.1f ns %7.1f ns\n\n", "voltage to duty",
+           time_per_call(analytic_voltage_to_pwm_percentage, MAX_DIMMER_VOLTAGE, calls), time_per_call(table_voltage_to_pwm_percentage, MAX_DIMMER_VOLTAGE, calls));
+
+    float worst_input;
+    float error = max_error(table_pwm_percentage_to_voltage, analytic_pwm_percentage_to_voltage, 1.0, &worst_input);
+    printf("  max duty to voltage error  %.4f V at duty %.4f\n", error, worst_input);
+    error = max_error(table_voltage_to_pwm_percentage, analytic_voltage_to_pwm_percentage, MAX_DIMMER_VOLTAGE, &worst_input);
+    printf("  max voltage to duty error  %.5f duty at %.3f V\n", error, worst_input);
+    return 0;
+}
@@ -0,0 +1,247 @@
+// Minimal host-side stand-in for the parts of the Arduino-ESP32 core used by the platform
+// firmware, so individual modules can be compiled and benchmarked on Linux.
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <math.h>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <unistd.h>
+#include <poll.h>
+
+#define SERIAL_8N1 0x800001c
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::max;
+using std::min;
+
+inline uint64_t host_elapsed_micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t micros() { return (uint32_t)host_elapsed_micros(); }
+
+inline uint32_t millis() { return (uint32_t)(host_elapsed_micros() / 1000); }
+
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+inline void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+class String {
+public:
+    String() {}
+    String(const char *value) : value(value) {}
+    String(const std::string &value) : value(value) {}
+
+    int indexOf(char c) const
+    {
+        size_t index = this->value.find(c);
+        return index == std::string::npos ? -1 : (int)index;
+    }
+
+    String substring(int begin) const { return String(this->value.substr(begin)); }
+
+    String substring(int begin, int end) const { return String(this->value.substr(begin, end < 0 ? 0 : end - begin)); }
+
+    long toInt() const { return strtol(this->value.c_str(), nullptr, 10); }
+
+    float toFloat() const { return strtof(this->value.c_str(), nullptr); }
+
+    const char *c_str() const { return this->value.c_str(); }
+
+    size_t length() const { return this->value.size(); }
+
+private:
+    std::string value;
+};
+
+// Serial port backed by a file descriptor (a pty or pipe). With no descriptor attached, output
+// is only counted, which is what the encoding benchmarks want.
+class HardwareSerial {
+public:
+    HardwareSerial(int rx_fd = -1, int tx_fd = -1) : rx_fd(rx_fd), tx_fd(tx_fd), timeout(1000), bytes_written(0) {}
+
+    void attach(int rx_fd, int tx_fd)
+    {
+        this->rx_fd = rx_fd;
+        this->tx_fd = tx_fd;
+    }
+
+    ~HardwareSerial()
+    {
+        this->receiving = false;
+        if (this->receive_thread.joinable())
+            this->receive_thread.join();
+    }
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx_pin = -1, int8_t tx_pin = -1) {}
+
+    size_t setTxBufferSize(size_t size) { return size; }
+
+    // Stands in for the UART event task: calls the callback whenever the descriptor has data.
+    void onReceive(std::function<void(void)> callback)
+    {
+        if (this->rx_fd < 0 || this->receive_thread.joinable())
+            return;
+
+        this->receiving = true;
+        this->receive_thread = std::thread([this, callback]() {
+            while (this->receiving) {
+                struct pollfd descriptor = {this->rx_fd, POLLIN, 0};
+                if (poll(&descriptor, 1, 10) > 0 && (descriptor.revents & POLLIN))
+                    callback();
+            }
+        });
+    }
+
+    operator bool() const { return true; }
+
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+
+    unsigned long getTimeout() const { return this->timeout; }
+
+    size_t write(uint8_t byte) { return this->write(&byte, 1); }
+
+    size_t write(const uint8_t *data, size_t length)
+    {
+        this->bytes_written += length;
+        if (this->tx_fd < 0)
+            return length;
+
+        size_t written = 0;
+        while (written < length) {
+            ssize_t n = ::write(this->tx_fd, data + written, length - written);
+            if (n <= 0)
+                break;
+            written += n;
+        }
+        return written;
+    }
+
+    size_t print(const char *text) { return this->write((const uint8_t *)text, strlen(text)); }
+
+    size_t print(float value) { return this->printf("%.2f", value); }
+
+    size_t println(const char *text) { return this->print(text) + this->print("\n"); }
+
+    size_t println(float value) { return this->print(value) + this->print("\n"); }
+
+    size_t println(int value) { return this->printf("%d\n", value); }
+
+    size_t println(unsigned int value) { return this->printf("%u\n", value); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return this->write((const uint8_t *)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+    }
+
+    int available()
+    {
+        if (this->rx_fd < 0)
+            return 0;
+
+        struct pollfd descriptor = {this->rx_fd, POLLIN, 0};
+        return poll(&descriptor, 1, 0) > 0 && (descriptor.revents & POLLIN) ? 1 : 0;
+    }
+
+    int read()
+    {
+        uint8_t byte;
+        if (!this->available() || ::read(this->rx_fd, &byte, 1) != 1)
+            return -1;
+        return byte;
+    }
+
+    size_t readBytes(uint8_t *data, size_t length)
+    {
+        size_t count = 0;
+        while (count < length) {
+            int byte = this->timed_read();
+            if (byte < 0)
+                break;
+            data[count++] = byte;
+        }
+        return count;
+    }
+
+    String readStringUntil(char terminator)
+    {
+        std::string result;
+        int byte;
+        while ((byte = this->timed_read()) >= 0 && byte != terminator)
+            result += (char)byte;
+        return String(result);
+    }
+
+    size_t get_bytes_written() const { return this->bytes_written; }
+
+private:
+    int timed_read()
+    {
+        if (this->rx_fd < 0)
+            return -1;
+
+        struct pollfd descriptor = {this->rx_fd, POLLIN, 0};
+        if (poll(&descriptor, 1, (int)this->timeout) <= 0)
+            return -1;
+
+        uint8_t byte;
+        return ::read(this->rx_fd, &byte, 1) == 1 ? byte : -1;
+    }
+
+    int rx_fd;
+    int tx_fd;
+    unsigned long timeout;
+    size_t bytes_written;
+    std::atomic<bool> receiving{false};
+    std::thread receive_thread;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+// FreeRTOS subset used by the motor task. Tasks are threads, the tick is 1 ms and queues only
+// support the non-blocking calls the firmware makes.
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef struct HostQueue *QueueHandle_t;
+typedef std::thread *TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stack_size, void *parameter,
+    UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+
+TickType_t xTaskGetTickCount();
+
+void vTaskDelay(TickType_t ticks);
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment);
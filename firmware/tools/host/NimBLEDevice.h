@@ -0,0 +1,50 @@
+// Minimal host-side stand-in for the NimBLE types referenced by Peripheral, Characteristic and
+// Service. Nothing is advertised and notifications are dropped.
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+class NimBLEConnInfo {};
+
+class NimBLEServer;
+
+class NimBLEService;
+
+class NimBLEAttValue {
+public:
+    size_t length() const { return 0; }
+
+    const uint8_t *data() const { return nullptr; }
+};
+
+class NimBLECharacteristic;
+
+class NimBLECharacteristicCallbacks {
+public:
+    virtual ~NimBLECharacteristicCallbacks() {}
+
+    virtual void onWrite(NimBLECharacteristic *characteristic, NimBLEConnInfo& info) {}
+
+    virtual void onSubscribe(NimBLECharacteristic *characteristic, NimBLEConnInfo& info, uint16_t subValue) {}
+};
+
+class NimBLEServerCallbacks {
+public:
+    virtual ~NimBLEServerCallbacks() {}
+
+    virtual void onConnect(NimBLEServer *server, NimBLEConnInfo& info) {}
+
+    virtual void onDisconnect(NimBLEServer *server, NimBLEConnInfo& info, int reason) {}
+};
+
+class NimBLECharacteristic {
+public:
+    void setValue(float value) {}
+
+    void notify() {}
+
+    NimBLEAttValue getValue() { return NimBLEAttValue(); }
+};
@@ -0,0 +1,67 @@
+#include "Arduino.h"
+#include <vector>
+
+HardwareSerial Serial(-1, STDOUT_FILENO);
+HardwareSerial Serial1;
+
+// Single item queue, which is all xQueueOverwrite() allows.
+struct HostQueue {
+    std::mutex mutex;
+    std::vector<uint8_t> item;
+    bool full;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = new HostQueue();
+    queue->item.resize(item_size);
+    queue->full = false;
+    return queue;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->full)
+        return pdFALSE;
+
+    memcpy(item, queue->item.data(), queue->item.size());
+    queue->full = false;
+    return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    memcpy(queue->item.data(), item, queue->item.size());
+    queue->full = true;
+    return pdTRUE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stack_size, void *parameter,
+    UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    std::thread *thread = new std::thread(task, parameter);
+    thread->detach();
+    if (handle != nullptr)
+        *handle = thread;
+    return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return millis();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment)
+{
+    *previous_wake_time += increment;
+    int32_t remaining = (int32_t)(*previous_wake_time - xTaskGetTickCount());
+    if (remaining > 0)
+        delay(remaining);
+}
@@ -0,0 +1,106 @@
+// Runs the current MotorController against the ODrive simulator over a pty and reports how many
+// setpoints reach the ODrive per second, the feedback rate the motor task achieves and how many
+// setpoints the command cache suppressed. The setpoint changes every loop iteration, like the
+// tension controller does.
+//
+// Build from firmware/:
+//   g++ -std=gnu++17 -O2 -I tools/host -I platform/src -D BAUD_RATE=115200 -D PLATFORM_TYPE=0
+//       tools/motor_benchmark.cpp tools/odrive_simulator.cpp tools/host/arduino.cpp
+//       platform/src/motor_controller.cpp platform/src/velocity_trajectory.cpp platform/src/odrive_*.cpp
+//       platform/src/ring_buffer.cpp platform/src/peripheral.cpp platform/src/characteristic.cpp
+//       -pthread -lutil -o motor_benchmark
+//
+// Usage: ./motor_benchmark [latency_ms] [jitter_ms] [drop_percent] [seconds] [sequential|pipelined]
+// "sequential" waits for each reply before sending the next request, "pipelined" (the default)
+// does not.
+
+#include <Arduino.h>
+#include <pty.h>
+#include <termios.h>
+#include "motor_controller.h"
+#include "odrive_simulator.h"
+
+static const float LOOP_INTERVAL = 0.001;
+static const float READY_TIMEOUT = 30.0;
+
+int main(int argc, char **argv)
+{
+    ODriveSimulatorConfig config;
+    config.baud_rate = BAUD_RATE;
+    config.saved_motor_calibration = true;
+    config.offset_calibration_time = 1.0;
+    float duration = 5.0;
+    bool sequential = false;
+    if (argc > 1)
+        config.latency = atof(argv[1]) / 1000.0;
+    if (argc > 2)
+        config.jitter = atof(argv[2]) / 1000.0;
+    if (argc > 3)
+        config.drop_rate = atof(argv[3]) / 100.0;
+    if (argc > 4)
+        duration = atof(argv[4]);
+    if (argc > 5) {
+        sequential = strcmp(argv[5], "sequential") == 0;
+        if (!sequential && strcmp(argv[5], "pipelined") != 0) {
+            fprintf(stderr, "unknown polling mode '%s', expected sequential or pipelined\n", argv[5]);
+            return 1;
+        }
+    }
+
+    int master, slave;
+    struct termios attributes;
+    cfmakeraw(&attributes);
+    if (openpty(&master, &slave, nullptr, &attributes, nullptr) != 0) {
+        perror("openpty");
+        return 1;
+    }
+
+    ODriveSimulator simulator(master, config);
+    simulator.start();
+
+    HardwareSerial serial(slave, slave);
+    MotorController motor("position", "velocity", "torque", "error", "calibration", &serial, -1, -1);
+    if (sequential)
+        motor.set_polling_mode(MotorPollingMode::SEQUENTIAL);
+    motor.start();
+
+    uint32_t start_time = micros();
+    while (motor.get_calibration_state() != (float)MotorCalibrationState::READY) {
+        if ((micros() - start_time) / 1e6 > READY_TIMEOUT) {
+            printf("motor not ready after %.0f s (calibration state %.0f, error %.0f)\n", READY_TIMEOUT,
+                motor.get_calibration_state(), motor.get_error());
+            return 1;
+        }
+        delay(10);
+    }
+
+    ODriveSimulatorStats before = simulator.get_stats();
+    size_t bytes_before = serial.get_bytes_written();
+    uint32_t velocity_suppressed = motor.get_suppressed_commands(MotorCommandType::VELOCITY);
+    uint32_t loops = 0;
+    start_time = micros();
+    float elapsed = 0.0;
+    while (elapsed < duration) {
+        motor.set_velocity(20.0 * sin(elapsed) + 0.1 * (loops % 7));
+        loops++;
+        delayMicroseconds((uint32_t)(LOOP_INTERVAL * 1e6));
+        elapsed = (micros() - start_time) / 1e6;
+    }
+    ODriveSimulatorStats after = simulator.get_stats();
+
+    printf("latency %.2f ms, jitter %.2f ms, %.1f%% dropped, %s polling, %.1f s\n", config.latency * 1000.0,
+        config.jitter * 1000.0, config.drop_rate * 100.0, sequential ? "sequential" : "pipelined", elapsed);
+    printf("  ready after         %8.2f s\n", motor.get_ready_time());
+    printf("  set_velocity calls  %8.0f /s\n", loops / elapsed);
+    printf("  velocity commands   %8.0f /s\n", (after.velocity_commands - before.velocity_commands) / elapsed);
+    printf("  suppressed          %8.0f /s\n", (motor.get_suppressed_commands(MotorCommandType::VELOCITY) - velocity_suppressed) / elapsed);
+    printf("  feedback requests   %8.0f /s\n", (after.feedback_requests - before.feedback_requests) / elapsed);
+    printf("  feedback rate       %8.0f /s\n", motor.get_feedback_rate());
+    printf("  dropped replies     %8u\n", after.dropped_replies - before.dropped_replies);
+    printf("  bytes to ODrive     %8.0f /s (UART budget %d /s)\n", (serial.get_bytes_written() - bytes_before) / elapsed, BAUD_RATE / 10);
+    printf("  motor error         %8.0f\n", motor.get_error());
+    fflush(stdout);
+
+    // The motor task runs forever, so leave without unwinding.
+    _exit(0);
+}
@@ -0,0 +1,301 @@
+#include "odrive_simulator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <poll.h>
+#include <unistd.h>
+
+static const int AXIS_STATE_IDLE = 1;
+static const int AXIS_STATE_FULL_CALIBRATION_SEQUENCE = 3;
+static const int AXIS_STATE_ENCODER_OFFSET_CALIBRATION = 7;
+static const int AXIS_STATE_CLOSED_LOOP_CONTROL = 8;
+
+static const int PROCEDURE_RESULT_SUCCESS = 0;
+static const int PROCEDURE_RESULT_BUSY = 1;
+static const int PROCEDURE_RESULT_DISARMED = 3;
+
+static const int CONTROL_MODE_TORQUE = 1;
+static const int CONTROL_MODE_VELOCITY = 2;
+
+// Motor model: the velocity loop settles with this time constant and Iq follows the error.
+static const float VELOCITY_TIME_CONSTANT = 0.05;
+static const float VELOCITY_GAIN = 1.0;
+static const float TORQUE_CONSTANT = 7.4439;
+
+ODriveSimulator::ODriveSimulator(int fd, const ODriveSimulatorConfig &config)
+{
+    this->fd = fd;
+    this->config = config;
+    this->running = false;
+    this->random.seed(config.seed);
+    this->stats = {};
+    this->current_state = AXIS_STATE_IDLE;
+    this->procedure_result = PROCEDURE_RESULT_SUCCESS;
+    this->control_mode = CONTROL_MODE_VELOCITY;
+    this->motor_calibrated = config.saved_motor_calibration;
+    this->encoder_calibrated = config.saved_motor_calibration && config.saved_encoder_offset;
+    this->procedure_end_time = 0.0;
+    this->receive_time = 0.0;
+    this->last_simulation_time = 0.0;
+    this->input_velocity = 0.0;
+    this->input_torque = 0.0;
+    this->position = 0.0;
+    this->velocity = 0.0;
+    this->iq_setpoint = 0.0;
+}
+
+ODriveSimulator::~ODriveSimulator()
+{
+    this->stop();
+}
+
+void ODriveSimulator::start()
+{
+    if (this->running)
+        return;
+
+    this->last_simulation_time = this->get_time();
+    this->running = true;
+    this->thread = std::thread(&ODriveSimulator::run, this);
+}
+
+void ODriveSimulator::stop()
+{
+    this->running = false;
+    if (this->thread.joinable())
+        this->thread.join();
+}
+
+ODriveSimulatorStats ODriveSimulator::get_stats()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+int ODriveSimulator::get_current_state()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->current_state;
+}
+
+double ODriveSimulator::get_byte_time()
+{
+    return this->config.baud_rate == 0 ? 0.0 : 10.0 / this->config.baud_rate;
+}
+
+double ODriveSimulator::get_time()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ODriveSimulator::run()
+{
+    double boot_end_time = this->get_time() + this->config.boot_time;
+    char buffer[256];
+    while (this->running) {
+        int timeout = 1;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->replies.empty() && this->replies.front().due_time - this->get_time() <= 0.001)
+                timeout = 0;
+            if (!this->received.empty() && this->received.front().first - this->get_time() <= 0.001)
+                timeout = 0;
+        }
+
+        struct pollfd descriptor = {this->fd, POLLIN, 0};
+        ssize_t count = 0;
+        if (poll(&descriptor, 1, timeout) > 0 && (descriptor.revents & POLLIN))
+            count = ::read(this->fd, buffer, sizeof(buffer));
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        double time = this->get_time();
+        this->simulate(time);
+        // Whatever arrives while the ODrive is still booting is lost.
+        for (ssize_t i = 0; i < count && time >= boot_end_time; i++) {
+            this->receive_time = std::max(this->receive_time, time) + this->get_byte_time();
+            this->received.push_back({this->receive_time, buffer[i]});
+        }
+
+        while (!this->received.empty() && this->received.front().first <= time) {
+            char byte = this->received.front().second;
+            this->received.pop_front();
+            this->stats.bytes_received++;
+            if (byte == '\r')
+                continue;
+            if (byte != '\n') {
+                this->line += byte;
+                continue;
+            }
+            this->handle_line(this->line, time);
+            this->line.clear();
+        }
+        this->send_replies(time);
+    }
+}
+
+void ODriveSimulator::handle_line(const std::string &line, double time)
+{
+    char command = line.empty() ? 0 : line[0];
+    const char *arguments = line.size() > 2 ? line.c_str() + 2 : "";
+
+    if (command == 'v' || command == 'c') {
+        int axis;
+        float value;
+        if (sscanf(arguments, "%d %f", &axis, &value) != 2 || axis != 0) {
+            this->stats.invalid_commands++;
+            return;
+        }
+        if (command == 'v') {
+            this->control_mode = CONTROL_MODE_VELOCITY;
+            this->input_velocity = value;
+            this->stats.velocity_commands++;
+        } else {
+            this->control_mode = CONTROL_MODE_TORQUE;
+            this->input_torque = value;
+            this->stats.torque_commands++;
+        }
+
+    } else if (command == 'f') {
+        char text[64];
+        snprintf(text, sizeof(text), "%f %f", this->position, this->velocity);
+        this->stats.feedback_requests++;
+        this->reply(text, time);
+
+    } else if (command == 'r') {
+        this->stats.reads++;
+        this->handle_read(arguments, time);
+
+    } else if (command == 'w') {
+        char path[128];
+        float value;
+        if (sscanf(arguments, "%127s %f", path, &value) != 2) {
+            this->stats.invalid_commands++;
+            return;
+        }
+        this->stats.writes++;
+        this->handle_write(path, value, time);
+
+    } else {
+        this->stats.invalid_commands++;
+    }
+}
+
+void ODriveSimulator::handle_read(const std::string &path, double time)
+{
+    char text[64];
+    if (path == "axis0.current_state")
+        snprintf(text, sizeof(text), "%d", this->current_state);
+    else if (path == "axis0.procedure_result")
+        snprintf(text, sizeof(text), "%d", this->procedure_result);
+    else if (path == "axis0.controller.config.control_mode")
+        snprintf(text, sizeof(text), "%d", this->control_mode);
+    else if (path == "axis0.config.motor.phase_resistance_valid")
+        snprintf(text, sizeof(text), "%d", this->motor_calibrated ? 1 : 0);
+    else if (path == "axis0.commutation_mapper.config.offset_valid")
+        snprintf(text, sizeof(text), "%d", this->encoder_calibrated ? 1 : 0);
+    else if (path == "axis0.pos_estimate")
+        snprintf(text, sizeof(text), "%f", this->position);
+    else if (path == "axis0.vel_estimate")
+        snprintf(text, sizeof(text), "%f", this->velocity);
+    else if (path == "axis0.motor.foc.Iq_setpoint")
+        snprintf(text, sizeof(text), "%f", this->iq_setpoint);
+    else if (path == "axis0.controller.input_vel")
+        snprintf(text, sizeof(text), "%f", this->input_velocity);
+    else if (path == "axis0.controller.input_torque")
+        snprintf(text, sizeof(text), "%f", this->input_torque);
+    else
+        snprintf(text, sizeof(text), "invalid property");
+    this->reply(text, time);
+}
+
+void ODriveSimulator::handle_write(const std::string &path, float value, double time)
+{
+    if (path == "axis0.controller.config.control_mode") {
+        this->control_mode = (int)value;
+    } else if (path == "axis0.controller.input_vel") {
+        this->input_velocity = value;
+        this->stats.velocity_commands++;
+    } else if (path == "axis0.controller.input_torque") {
+        this->input_torque = value;
+        this->stats.torque_commands++;
+    } else if (path == "axis0.requested_state") {
+        int state = (int)value;
+        if (state == AXIS_STATE_IDLE) {
+            this->current_state = AXIS_STATE_IDLE;
+        } else if (state == AXIS_STATE_FULL_CALIBRATION_SEQUENCE) {
+            this->current_state = state;
+            this->procedure_result = PROCEDURE_RESULT_BUSY;
+            this->procedure_end_time = time + this->config.calibration_time;
+        } else if (state == AXIS_STATE_ENCODER_OFFSET_CALIBRATION && this->motor_calibrated) {
+            this->current_state = state;
+            this->procedure_result = PROCEDURE_RESULT_BUSY;
+            this->procedure_end_time = time + this->config.offset_calibration_time;
+        } else if (state == AXIS_STATE_CLOSED_LOOP_CONTROL && this->motor_calibrated && this->encoder_calibrated) {
+            this->current_state = state;
+            this->procedure_result = PROCEDURE_RESULT_SUCCESS;
+        } else {
+            this->current_state = AXIS_STATE_IDLE;
+            this->procedure_result = PROCEDURE_RESULT_DISARMED;
+        }
+    }
+}
+
+void ODriveSimulator::reply(const std::string &text, double time)
+{
+    if (std::uniform_real_distribution<float>(0.0, 1.0)(this->random) < this->config.drop_rate) {
+        this->stats.dropped_replies++;
+        return;
+    }
+
+    // The ODrive answers in order, so a reply is never sent before the one ahead of it, and it
+    // only arrives once all of its bytes have been clocked out.
+    std::string line = text + "\r\n";
+    double due_time = time + this->config.latency + std::uniform_real_distribution<float>(0.0, this->config.jitter)(this->random);
+    if (!this->replies.empty())
+        due_time = std::max(due_time, this->replies.back().due_time);
+    due_time += line.size() * this->get_byte_time();
+    this->replies.push_back({due_time, line});
+}
+
+void ODriveSimulator::send_replies(double time)
+{
+    while (!this->replies.empty() && this->replies.front().due_time <= time) {
+        const std::string &text = this->replies.front().text;
+        if (::write(this->fd, text.data(), text.size()) == (ssize_t)text.size())
+            this->stats.replies++;
+        this->replies.pop_front();
+    }
+}
+
+void ODriveSimulator::simulate(double time)
+{
+    float dt = time - this->last_simulation_time;
+    this->last_simulation_time = time;
+
+    bool calibrating = this->current_state == AXIS_STATE_FULL_CALIBRATION_SEQUENCE
+        || this->current_state == AXIS_STATE_ENCODER_OFFSET_CALIBRATION;
+    if (calibrating && time >= this->procedure_end_time) {
+        if (this->current_state == AXIS_STATE_FULL_CALIBRATION_SEQUENCE)
+            this->motor_calibrated = true;
+        this->encoder_calibrated = true;
+        this->current_state = AXIS_STATE_IDLE;
+        this->procedure_result = PROCEDURE_RESULT_SUCCESS;
+    }
+
+    if (this->current_state != AXIS_STATE_CLOSED_LOOP_CONTROL) {
+        this->velocity = 0.0;
+        this->iq_setpoint = 0.0;
+        return;
+    }
+
+    if (this->control_mode == CONTROL_MODE_VELOCITY) {
+        float error = this->input_velocity - this->velocity;
+        this->iq_setpoint = VELOCITY_GAIN * error / TORQUE_CONSTANT;
+        this->velocity += error * (1.0 - exp(-dt / VELOCITY_TIME_CONSTANT));
+    } else {
+        this->iq_setpoint = this->input_torque / TORQUE_CONSTANT;
+    }
+    this->position += this->velocity * dt;
+}
@@ -0,0 +1,102 @@
+// Host-side simulation of an ODrive on the other end of a pty or pipe. It implements the part of
+// the ASCII protocol the platform firmware uses (r, w, v, c and f commands, axis states and
+// calibration procedures) with a crude motor model, and can delay, jitter and drop its replies.
+// Both directions are paced at the configured baud rate (8N1) since a pty transfers instantly.
+
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+struct ODriveSimulatorConfig {
+    uint32_t baud_rate = 115200;
+    float latency = 0.0005;
+    float jitter = 0.0;
+    float drop_rate = 0.0;
+    float boot_time = 0.5;
+    float calibration_time = 8.0;
+    float offset_calibration_time = 2.0;
+    bool saved_motor_calibration = false;
+    bool saved_encoder_offset = false;
+    uint32_t seed = 1;
+};
+
+struct ODriveSimulatorStats {
+    uint32_t velocity_commands;
+    uint32_t torque_commands;
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t feedback_requests;
+    uint32_t replies;
+    uint32_t dropped_replies;
+    uint32_t invalid_commands;
+    uint64_t bytes_received;
+};
+
+class ODriveSimulator {
+public:
+    ODriveSimulator(int fd, const ODriveSimulatorConfig &config);
+
+    ~ODriveSimulator();
+
+    void start();
+
+    void stop();
+
+    ODriveSimulatorStats get_stats();
+
+    int get_current_state();
+
+private:
+    struct Reply {
+        double due_time;
+        std::string text;
+    };
+
+    void run();
+
+    void handle_line(const std::string &line, double time);
+
+    void handle_read(const std::string &path, double time);
+
+    void handle_write(const std::string &path, float value, double time);
+
+    void reply(const std::string &text, double time);
+
+    void send_replies(double time);
+
+    void simulate(double time);
+
+    double get_time();
+
+    double get_byte_time();
+
+    int fd;
+    ODriveSimulatorConfig config;
+    std::mutex mutex;
+    std::atomic<bool> running;
+    std::thread thread;
+    std::mt19937 random;
+    std::deque<Reply> replies;
+    std::deque<std::pair<double, char>> received;
+    double receive_time;
+    std::string line;
+    ODriveSimulatorStats stats;
+
+    int current_state;
+    int procedure_result;
+    int control_mode;
+    bool motor_calibrated;
+    bool encoder_calibrated;
+    double procedure_end_time;
+    double last_simulation_time;
+    float input_velocity;
+    float input_torque;
+    float position;
+    float velocity;
+    float iq_setpoint;
+};
@@ -0,0 +1,66 @@
+// Runs the ODrive simulator on a new pty and prints its path, so it can stand in for an ODrive
+// for anything that opens a serial port (odrivetool-style scripts, a terminal, a host build).
+// Statistics are printed every second.
+//
+// Build from firmware/:
+//   g++ -std=gnu++17 -O2 tools/odrive_simulator_pty.cpp tools/odrive_simulator.cpp -pthread -o odrive_simulator
+//
+// Usage: ./odrive_simulator [latency_ms] [jitter_ms] [drop_percent] [saved_calibration]
+
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "odrive_simulator.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void handle_signal(int signal)
+{
+    running = 0;
+}
+
+int main(int argc, char **argv)
+{
+    ODriveSimulatorConfig config;
+    if (argc > 1)
+        config.latency = atof(argv[1]) / 1000.0;
+    if (argc > 2)
+        config.jitter = atof(argv[2]) / 1000.0;
+    if (argc > 3)
+        config.drop_rate = atof(argv[3]) / 100.0;
+    if (argc > 4)
+        config.saved_motor_calibration = atoi(argv[4]) != 0;
+
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+    struct termios attributes;
+    tcgetattr(fd, &attributes);
+    cfmakeraw(&attributes);
+    tcsetattr(fd, TCSANOW, &attributes);
+
+    printf("ODrive simulator on %s (latency %.2f ms, jitter %.2f ms, %.1f%% dropped)\n", ptsname(fd),
+        config.latency * 1000.0, config.jitter * 1000.0, config.drop_rate * 100.0);
+    fflush(stdout);
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    ODriveSimulator simulator(fd, config);
+    simulator.start();
+    while (running) {
+        sleep(1);
+        ODriveSimulatorStats stats = simulator.get_stats();
+        printf("state %d  v/c %u/%u  w %u  r %u  f %u  replies %u  dropped %u  invalid %u\n", simulator.get_current_state(),
+            stats.velocity_commands, stats.torque_commands, stats.writes, stats.reads, stats.feedback_requests,
+            stats.replies, stats.dropped_replies, stats.invalid_commands);
+        fflush(stdout);
+    }
+    simulator.stop();
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Runs a pressure trace through PressureFilter configurations and reports how much spike energy
+// each removes, the delay it adds and the peak derivative PressureHistory fits to its output. The
+// spike energy is the squared difference from a centred 15-sample median of the raw trace, taken
+// at the delay that fits the output best, so the lag of the filter is not counted as spikes.
+//
+// Traces are text files with either "time_s,psi" or one reading per line, or the ">Pressure 1: "
+// lines main.cpp prints for Teleplot. Building the platform with PRESSURE_TRACE=1 prints the first
+// sensor's samples as "time_s,psi". Without a file argument the trace in tools/traces/ is used,
+// and if there is none a synthetic inflation trace with turbulence spikes.
+//
+// Build from firmware/:
+//   g++ -std=gnu++17 -O2 -I tools/host -I platform/src -D PLATFORM_TYPE=0
+//       tools/pressure_filter_report.cpp tools/host/arduino.cpp
+//       platform/src/pressure_filter.cpp platform/src/pressure_history.cpp
+//       -pthread -o pressure_filter_report
+//
+// Usage: ./pressure_filter_report [trace_file] [sample_rate_hz]
+
+#include <Arduino.h>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "pressure_filter.h"
+#include "pressure_history.h"
+
+static const char *DEFAULT_TRACE = "tools/traces/pressure_trace.csv";
+static const float DEFAULT_SAMPLE_RATE = 100.0;
+static const int REFERENCE_WIDTH = 15;
+static const int MAX_DELAY = 30;
+static const int DERIVATIVE_WINDOW = 9;
+
+struct Trace {
+    std::vector<float> psi;
+    std::vector<uint32_t> time;
+};
+
+struct FilterConfig {
+    const char *name;
+    int oversampling;
+    int median_size;
+    float time_constant;
+};
+
+static const FilterConfig CONFIGS[] = {
+    {"low-pass only (previous)", 1, 1, 0.035},
+    {"median 3", 1, 3, 0.035},
+    {"median 5 (default)", 1, 5, 0.035},
+    {"oversample 2, median 3", 2, 3, 0.035},
+};
+
+static bool load_trace(const char *path, float sample_rate, Trace *trace)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t colon = line.find(':');
+        if (!line.empty() && line[0] == '>' && colon != std::string::npos)
+            line = line.substr(colon + 1);
+
+        // Firmware traces run to thousands of seconds, too long for float microseconds.
+        double time;
+        float psi;
+        if (sscanf(line.c_str(), "%lf,%f", &time, &psi) == 2) {
+            trace->time.push_back((uint32_t)(time * 1e6));
+        } else if (sscanf(line.c_str(), "%f", &psi) == 1) {
+            trace->time.push_back((uint32_t)(trace->psi.size() * 1e6 / sample_rate));
+        } else {
+            continue;
+        }
+        trace->psi.push_back(psi);
+    }
+    return !trace->psi.empty();
+}
+
+// Inflate, hold and deflate with sensor noise, single-sample spikes and the odd two-sample burst.
+static void synthesize_trace(float sample_rate, Trace *trace)
+{
+    std::mt19937 random(1);
+    std::normal_distribution<float> noise(0.0, 0.003);
+    std::uniform_real_distribution<float> uniform(0.0, 1.0);
+    int count = (int)(20.0 * sample_rate);
+    int burst = 0;
+    float spike = 0.0;
+    for (int i = 0; i < count; i++) {
+        float t = i / sample_rate;
+        float psi;
+        if (t < 2.0)
+            psi = 0.0;
+        else if (t < 5.0)
+            psi = 0.5 * (t - 2.0);
+        else if (t < 12.0)
+            psi = 1.5;
+        else if (t < 14.0)
+            psi = 1.5 - 0.75 * (t - 12.0);
+        else
+            psi = 0.0;
+
+        if (burst == 0 && uniform(random) < 0.02) {
+            burst = uniform(random) < 0.2 ? 2 : 1;
+            spike = (uniform(random) < 0.5 ? -1.0 : 1.0) * (0.05 + 0.25 * uniform(random));
+        }
+        if (burst > 0) {
+            psi += spike;
+            burst--;
+        }
+        trace->psi.push_back(psi + noise(random));
+        trace->time.push_back((uint32_t)(i * 1e6 / sample_rate));
+    }
+}
+
+static std::vector<float> centred_median(const std::vector<float> &values, int width)
+{
+    std::vector<float> result(values.size());
+    for (int i = 0; i < (int)values.size(); i++) {
+        int begin = max(0, i - width / 2);
+        int end = min((int)values.size(), i + width / 2 + 1);
+        std::vector<float> window(values.begin() + begin, values.begin() + end);
+        std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+        result[i] = window[window.size() / 2];
+    }
+    return result;
+}
+
+// Squared error against the reference with the output shifted back by `delay` samples.
+static double spike_energy(const std::vector<float> &output, const std::vector<int> &index, const std::vector<float> &reference, int delay)
+{
+    double energy = 0.0;
+    for (size_t i = 0; i < output.size(); i++) {
+        int j = index[i] - delay;
+        if (j < REFERENCE_WIDTH || j >= (int)reference.size() - REFERENCE_WIDTH)
+            continue;
+        double error = output[i] - reference[j];
+        energy += error * error;
+    }
+    return energy;
+}
+
+int main(int argc, char **argv)
+{
+    float sample_rate = argc > 2 ? atof(argv[2]) : DEFAULT_SAMPLE_RATE;
+    const char *path = argc > 1 ? argv[1] : DEFAULT_TRACE;
+    Trace trace;
+    if (load_trace(path, sample_rate, &trace)) {
+        printf("%s: %zu samples\n", path, trace.psi.size());
+    } else if (argc > 1) {
+        fprintf(stderr, "could not read a trace from %s\n", path);
+        return 1;
+    } else {
+        synthesize_trace(sample_rate, &trace);
+        printf("no trace in %s, synthetic trace: %zu samples at %.0f Hz, true peak derivative 0.75 psi/s\n", path, trace.psi.size(), sample_rate);
+    }
+
+    std::vector<float> reference = centred_median(trace.psi, REFERENCE_WIDTH);
+    std::vector<int> raw_index(trace.psi.size());
+    for (size_t i = 0; i < raw_index.size(); i++)
+        raw_index[i] = i;
+    double raw_energy = spike_energy(trace.psi, raw_index, reference, 0);
+    float period = (trace.time.back() - trace.time.front()) / 1e3 / max((size_t)1, trace.psi.size() - 1);
+    printf("  raw spike energy %.4f psi^2\n\n", raw_energy);
+    printf("  %-26s %10s %10s %12s\n", "filter", "removed", "delay", "peak dP/dt");
+
+    for (const FilterConfig &config : CONFIGS) {
+        PressureFilter filter;
+        PressureHistory history;
+        filter.configure(config.oversampling, config.median_size, config.time_constant);
+        std::vector<float> output;
+        std::vector<int> index;
+        float peak_derivative = 0.0;
+        int group_start = 0;
+        for (size_t i = 0; i < trace.psi.size(); i++) {
+            if (i % config.oversampling == 0)
+                group_start = i;
+            if (!filter.add(trace.psi[i], trace.time[i]))
+                continue;
+            output.push_back(filter.get_output());
+            index.push_back(group_start);
+            history.push(filter.get_despiked(), filter.get_time());
+            peak_derivative = max(peak_derivative, abs(history.get_derivative(DERIVATIVE_WINDOW)));
+        }
+
+        int best_delay = 0;
+        double best_energy = spike_energy(output, index, reference, 0);
+        for (int delay = 1; delay <= MAX_DELAY; delay++) {
+            double energy = spike_energy(output, index, reference, delay);
+            if (energy < best_energy) {
+                best_energy = energy;
+                best_delay = delay;
+            }
+        }
+        printf("  %-26s %9.1f%% %7.0f ms %8.2f psi/s\n", config.name, 100.0 * (1.0 - best_energy / raw_energy), best_delay * period, peak_derivative);
+    }
+    return 0;
+}